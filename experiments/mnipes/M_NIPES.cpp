@@ -1,5 +1,6 @@
 #include "M_NIPES.hpp"
 #include "tools.hpp"
+#include <cassert>
 
 using namespace are;
 static auto sw = stopwatch();
@@ -114,10 +115,14 @@ void M_NIPESIndividual::createController(){
 }
 
 void M_NIPESIndividual::update(double delta_time){
-    std::vector<double> inputs = morphology->update();
-    std::vector<double> outputs = control->update(inputs);
-
-    morphology->command(outputs);
+    if(!control_clock.is_set())
+        control_clock.set_period(control_period(parameters),settings::getParameter<settings::Float>(parameters,"#timeStep").value);
+    // the sensors and the controller run every #controlPeriod, the commands are held in between
+    if(control_clock.due(delta_time)){
+        std::vector<double> inputs = morphology->update();
+        std::vector<double> outputs = control->update(inputs);
+        morphology->command(outputs);
+    }
     energy_cost += std::dynamic_pointer_cast<CPPNMorph>(morphology)->get_energy_cost();
     if(std::isnan(energy_cost))
         energy_cost = 0;
@@ -142,15 +147,23 @@ void M_NIPESIndividual::setManRes()
 
 
 Eigen::VectorXd M_NIPESIndividual::descriptor(){
+    return get_descriptor();
+}
+
+const Eigen::VectorXd& M_NIPESIndividual::get_descriptor(){
+    if(cached_descriptor.size() == 0)
+        cache_descriptor();
+    return cached_descriptor;
+}
+
+void M_NIPESIndividual::cache_descriptor(){
     if(descriptor_type == FINAL_POSITION){
         double arena_size = settings::getParameter<settings::Double>(parameters,"#arenaSize").value;
-        Eigen::VectorXd desc(3);
-        desc << (final_position[0]+arena_size/2.)/arena_size, (final_position[1]+arena_size/2.)/arena_size, (final_position[2]+arena_size/2.)/arena_size;
-        return desc;
+        cached_descriptor.resize(3);
+        for(int i = 0; i < 3; i++)
+            cached_descriptor(i) = (final_position[i]+arena_size/2.)/arena_size;
     }else if(descriptor_type == VISITED_ZONES){
-        Eigen::MatrixXd vz = visited_zones.cast<double>();
-        Eigen::VectorXd desc(Eigen::Map<Eigen::VectorXd>(vz.data(),vz.cols()*vz.rows()));
-        return desc;
+        cached_descriptor = visited_zones.to_vector();
     }
 }
 
@@ -192,6 +205,26 @@ void M_NIPES::init(){
     bool use_ctrl_arch = settings::getParameter<settings::Boolean>(parameters,"#useControllerArchive").value;
     int fitness_type = settings::getParameter<settings::Integer>(parameters,"#fitnessType").value;
 
+    settings::defaults::parameters->emplace("#learnerEarlyStopping",new settings::String("standard"));
+    settings::defaults::parameters->emplace("#watchdogFactor",new settings::Double(0.));
+    settings::defaults::parameters->emplace("#watchdogMinTime",new settings::Double(60.));
+    settings::defaults::parameters->emplace("#noveltyIndex",new settings::String("exact"));
+    settings::defaults::parameters->emplace("#noveltyIndexEpsilon",new settings::Double(0.1));
+    settings::defaults::parameters->emplace("#archiveMaxSize",new settings::Integer(0));
+    settings::defaults::parameters->emplace("#archiveEviction",new settings::String("least_novel"));
+    settings::defaults::parameters->emplace("#archiveCellSize",new settings::Double(0.1));
+    // the server requeues the individual of a client that exits, a single instance would only lose the run
+    watchdog.set_limits(instance_type == 0 ? 0 : settings::getParameter<settings::Double>(parameters,"#watchdogFactor").value,
+                        settings::getParameter<settings::Double>(parameters,"#watchdogMinTime").value);
+    EarlyStoppingRegistry::set_default_parameters();
+    // read once, finish_eval compares them at every tick
+    target_position[0] = settings::getParameter<settings::Double>(parameters,"#target_x").value;
+    target_position[1] = settings::getParameter<settings::Double>(parameters,"#target_y").value;
+    target_position[2] = settings::getParameter<settings::Double>(parameters,"#target_z").value;
+    target_distance = settings::getParameter<settings::Double>(parameters,"#FTarget").value;
+    arena_size = settings::getParameter<settings::Double>(parameters,"#arenaSize").value;
+    time_step = settings::getParameter<settings::Float>(parameters,"#timeStep").value;
+
     if(fitness_type == BEST_FIT)
         fitness_fct = FitnessFunctions::best_fitness;
     else if(fitness_type == AVG_FIT)
@@ -402,9 +435,10 @@ bool M_NIPES::update_maze(const Environment::Ptr &env){
     if(simulator_side){
         std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->set_final_position(env->get_final_position());
         std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->set_trajectory(env->get_trajectory());
+        std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->cache_descriptor();
         std::dynamic_pointer_cast<CMAESLearner>(ind->get_learner())->update_pop_info(
                     ind->getObjectives(),
-                    std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->descriptor()
+                    std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->get_descriptor()
                     );
 
         //LEARNING WITH NIP-ES
@@ -435,14 +469,15 @@ bool M_NIPES::update_obstacle_avoidance(const Environment::Ptr &env){
         }
 
         std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->set_final_position(env->get_final_position());
-        std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->set_trajectory(env->get_trajectory());
-        std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->set_visited_zones(std::dynamic_pointer_cast<sim::ObstacleAvoidance>(env)->get_visited_zone_matrix());
+        std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->take_trajectory(std::dynamic_pointer_cast<sim::ObstacleAvoidance>(env)->release_trajectory());
+        std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->set_visited_zones(std::dynamic_pointer_cast<sim::ObstacleAvoidance>(env)->get_visited_zones());
         std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->set_descriptor_type(VISITED_ZONES);
+        std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->cache_descriptor();
 
         //LEARNING WITH NIP-ES
         std::dynamic_pointer_cast<CMAESLearner>(ind->get_learner())->update_pop_info(
                     ind->getObjectives(),
-                    std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->descriptor()
+                    std::dynamic_pointer_cast<M_NIPESIndividual>(ind)->get_descriptor()
                     );
         learning_finished = std::dynamic_pointer_cast<CMAESLearner>(ind->get_learner())->step();
 
@@ -462,7 +497,11 @@ bool M_NIPES::update(const Environment::Ptr& env){
     std::cout << "update() " << sw.toc() << std::endl;
     sw.tic();
     n_of_ticks = 0;
+    // the next evaluation looks up its own morphology and learner
+    current_handle = -1;
+    current_learner = nullptr;
     if(simulator_side){
+        watchdog.end_eval();
         if(env->get_name() == "mazeEnv")
             return update_maze(env);
         else if(env->get_name() == "obstacle_avoidance")
@@ -618,15 +657,23 @@ int M_NIPES::findLastGen(const std::string &exp_folder){
 
 bool M_NIPES::finish_eval(const Environment::Ptr &env){
     n_of_ticks++;
-    int handle = std::dynamic_pointer_cast<CPPNMorph>(population[currentIndIndex]->get_morphology())->getMainHandle();
+    double sim_time = simGetSimulationTime();
+    bool first_tick = sim_time < time_step*1.5;
+    // the morphology and the learner of the individual stay the same during its evaluation
+    if(first_tick || !current_learner){
+        current_handle = std::static_pointer_cast<CPPNMorph>(population[currentIndIndex]->get_morphology())->getMainHandle();
+        current_learner = static_cast<CMAESLearner*>(population[currentIndIndex]->get_learner().get());
+    }
+    assert(current_handle >= 0 && current_learner);
     float pos[3];
-    simGetObjectPosition(handle,-1,pos);
+    simGetObjectPosition(current_handle,-1,pos);
 
-    if(simGetSimulationTime() < 0.1){
+    if(first_tick){
         current_ind_past_pos[0] = pos[0];
         current_ind_past_pos[1] = pos[1];
         current_ind_past_pos[2] = pos[2];
         move_counter = 0;
+        watchdog.start_eval(settings::getParameter<settings::Float>(parameters,"#maxEvalTime").value,sim_time);
     }else{
         if(fabs(current_ind_past_pos[0] - pos[0]) > 1e-3 ||
                 fabs(current_ind_past_pos[1] - pos[1]) > 1e-3 ||
@@ -638,18 +685,15 @@ bool M_NIPES::finish_eval(const Environment::Ptr &env){
         current_ind_past_pos[2] = pos[2];
     }
 
-    bool drop_eval = simGetSimulationTime() > 10.0 && move_counter <= 10;
+    watchdog.tick(sim_time);
+
+    bool drop_eval = sim_time > 10.0 && move_counter <= 10;
     if(drop_eval) nbr_dropped_eval++;
 
+    bool early_stop = current_learner->early_stop(env,population[currentIndIndex],sim_time);
+
     if(env->get_name() == "mazeEnv")
     {
-        float tPos[3];
-        tPos[0] = settings::getParameter<settings::Double>(parameters,"#target_x").value;
-        tPos[1] = settings::getParameter<settings::Double>(parameters,"#target_y").value;
-        tPos[2] = settings::getParameter<settings::Double>(parameters,"#target_z").value;
-        double fTarget = settings::getParameter<settings::Double>(parameters,"#FTarget").value;
-        double arenaSize = settings::getParameter<settings::Double>(parameters,"#arenaSize").value;
-
         auto distance = [](float* a,float* b) -> double
         {
             return std::sqrt((a[0] - b[0])*(a[0] - b[0]) +
@@ -657,9 +701,9 @@ bool M_NIPES::finish_eval(const Environment::Ptr &env){
                     (a[2] - b[2])*(a[2] - b[2]));
         };
 
-        double dist = distance(pos,tPos)/sqrt(2*arenaSize*arenaSize);
+        double dist = distance(pos,target_position)/sqrt(2*arena_size*arena_size);
 
-        bool stop = dist < fTarget || drop_eval;
+        bool stop = dist < target_distance || drop_eval || early_stop;
 
         if(stop){
             std::cout << "STOP !" << std::endl;
@@ -667,6 +711,6 @@ bool M_NIPES::finish_eval(const Environment::Ptr &env){
 
         return  stop;
     }else if(env->get_name() == "obstacle_avoidance"){
-        return drop_eval;
+        return drop_eval || early_stop;
     }
 }
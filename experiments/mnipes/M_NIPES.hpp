@@ -8,10 +8,13 @@
 #include "ARE/nn2/NN2Control.hpp"
 #include "simulatedER/Morphology_CPPNMatrix.h"
 #include "cmaes_learner.hpp"
+#include "visited_grid.hpp"
 #include "ARE/misc/eigen_boost_serialization.hpp"
 #include <multineat/Population.h>
 #include "ARE/learning/controller_archive.hpp"
 #include "obstacleAvoidance.hpp"
+#include "tools.hpp"
+#include "eval_watchdog.hpp"
 
 namespace are{
 
@@ -60,7 +63,10 @@ public:
         trajectory(ind.trajectory),
         energy_cost(ind.energy_cost),
         sim_time(ind.sim_time),
-        controller_archive(ind.controller_archive)
+        controller_archive(ind.controller_archive),
+        visited_zones(ind.visited_zones),
+        descriptor_type(ind.descriptor_type),
+        cached_descriptor(ind.cached_descriptor)
     {}
 
     Individual::Ptr clone() override {
@@ -70,10 +76,15 @@ public:
     void update(double delta_time) override;
 
     //specific to the current ARE arenas
-    Eigen::VectorXd descriptor();
-    void set_final_position(const std::vector<double>& final_pos){final_position = final_pos;}
+    Eigen::VectorXd descriptor() override;
+    /// The descriptor cached at the end of the evaluation, computed on the first call if it was not cached.
+    const Eigen::VectorXd& get_descriptor();
+    /// Compute the descriptor of the evaluation that just ended, once the final position and visited zones are set.
+    void cache_descriptor();
+    void set_final_position(const std::vector<double>& final_pos){final_position = final_pos; cached_descriptor.resize(0);}
     const std::vector<double>& get_final_position(){return final_position;}
     void set_trajectory(const std::vector<waypoint>& traj){trajectory = traj;}
+    void take_trajectory(std::vector<waypoint>&& traj){trajectory = std::move(traj);}
     const std::vector<waypoint>& get_trajectory(){return trajectory;}
     double get_energy_cost(){return energy_cost;}
     double get_sim_time(){return sim_time;}
@@ -119,8 +130,8 @@ public:
 
     bool is_actuated(){return !no_actuation;}
     bool has_sensor(){return !no_sensors;}
-    void set_visited_zones(const Eigen::MatrixXi& vz){visited_zones = vz;}
-    void set_descriptor_type(DescriptorType dt){descriptor_type = dt;}
+    void set_visited_zones(const VisitedGrid& vz){visited_zones = vz; cached_descriptor.resize(0);}
+    void set_descriptor_type(DescriptorType dt){descriptor_type = dt; cached_descriptor.resize(0);}
 
 
 
@@ -142,14 +153,17 @@ private:
     std::vector<waypoint> trajectory;
     double sim_time;
     std::vector<double> final_position;
+    PeriodicClock control_clock;
 
     int nn_inputs;
     int nn_outputs;
 
     ControllerArchive controller_archive;
 
-    Eigen::MatrixXi visited_zones;
+    VisitedGrid visited_zones;
     DescriptorType descriptor_type = FINAL_POSITION;
+    // set by cache_descriptor() at the end of the evaluation, empty until then
+    Eigen::VectorXd cached_descriptor;
 };
 
 class M_NIPES : public EA
@@ -207,9 +221,20 @@ private:
     fitness_fct_t fitness_fct;
 
     float current_ind_past_pos[3];
+    // main handle and learner of the individual under evaluation, set at its first tick and reset by update()
+    int current_handle = -1;
+    CMAESLearner* current_learner = nullptr;
+    // #timeStep, the first tick of an evaluation is at one timestep
+    float time_step;
+    // #target_x/y/z, #FTarget and #arenaSize
+    float target_position[3];
+    double target_distance;
+    double arena_size;
     int move_counter = 0;
     int nbr_dropped_eval = 0;
     bool learning_finished = false;
+    // ends a simulator instance whose evaluation hangs, see #watchdogFactor
+    EvalWatchdog watchdog;
 
 };
 
@@ -0,0 +1,78 @@
+#include "archive_eviction.hpp"
+
+#include <cmath>
+#include <map>
+
+using namespace are;
+
+bool ArchiveEviction::set_policy(const std::string &name){
+    if(name == "reservoir")
+        policy = RESERVOIR;
+    else if(name == "least_novel")
+        policy = LEAST_NOVEL;
+    else if(name == "grid")
+        policy = GRID_DEDUP;
+    else return false;
+    return true;
+}
+
+int ArchiveEviction::on_insert(std::vector<Eigen::VectorXd> &archive, double novelty, const misc::RandNum::Ptr &rand_num){
+    nbr_seen++;
+    // the descriptors of an archive filled by other means are given the novelty of the new one
+    novelties.resize(archive.size() - 1,novelty);
+    novelties.push_back(novelty);
+    if(max_size <= 0 || archive.size() <= static_cast<size_t>(max_size))
+        return static_cast<int>(archive.size()) - 1;
+
+    int slot = static_cast<int>(archive.size()) - 1;
+    while(archive.size() > static_cast<size_t>(max_size)){
+        size_t v = victim(archive,rand_num);
+        size_t last = archive.size() - 1;
+        if(v != last){
+            archive[v] = std::move(archive[last]);
+            novelties[v] = novelties[last];
+        }
+        if(slot == static_cast<int>(last))
+            slot = v == last ? -1 : static_cast<int>(v);
+        archive.pop_back();
+        novelties.pop_back();
+    }
+    return slot;
+}
+
+size_t ArchiveEviction::victim(const std::vector<Eigen::VectorXd> &archive, const misc::RandNum::Ptr &rand_num) const{
+    std::vector<size_t> all(archive.size());
+    for(size_t i = 0; i < all.size(); i++)
+        all[i] = i;
+
+    if(policy == RESERVOIR){
+        // the new descriptor is kept with probability max_size/nbr_seen, in place of a uniformly drawn one
+        size_t r = static_cast<size_t>(rand_num->randInt(0,static_cast<int>(nbr_seen) - 1));
+        return r < archive.size() - 1 ? r : archive.size() - 1;
+    }
+    if(policy == GRID_DEDUP){
+        std::map<std::vector<long>,std::vector<size_t>> cells;
+        for(size_t i = 0; i < archive.size(); i++){
+            std::vector<long> cell(archive[i].size());
+            for(Eigen::Index d = 0; d < archive[i].size(); d++)
+                cell[d] = static_cast<long>(std::floor(archive[i](d)/cell_size));
+            cells[cell].push_back(i);
+        }
+        const std::vector<size_t>* crowded = &cells.begin()->second;
+        for(const auto& cell : cells)
+            if(cell.second.size() > crowded->size())
+                crowded = &cell.second;
+        // without two descriptors in a cell, the least novel one goes
+        if(crowded->size() > 1)
+            return least_novel(*crowded);
+    }
+    return least_novel(all);
+}
+
+size_t ArchiveEviction::least_novel(const std::vector<size_t> &candidates) const{
+    size_t least = candidates.front();
+    for(size_t i : candidates)
+        if(novelties[i] < novelties[least])
+            least = i;
+    return least;
+}
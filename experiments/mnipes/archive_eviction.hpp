@@ -0,0 +1,53 @@
+#ifndef ARCHIVE_EVICTION_HPP
+#define ARCHIVE_EVICTION_HPP
+
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+#include "ARE/misc/RandNum.h"
+
+namespace are {
+
+/**
+ * @brief Keeps a novelty archive within #archiveMaxSize descriptors. Once the archive is full, a descriptor added
+ * by Novelty::update_archive either takes the slot of an evicted one or is dropped, so the archive stays dense and
+ * the structures following it by slot, as NoveltyIndex, only see replacements.
+ */
+class ArchiveEviction
+{
+public:
+    typedef enum Policy{
+        // uniform sample of all the descriptors ever added
+        RESERVOIR = 0,
+        // the descriptor with the lowest novelty when it was added goes
+        LEAST_NOVEL = 1,
+        // the least novel descriptor of the most crowded cell of a grid of the descriptor space goes
+        GRID_DEDUP = 2
+    }Policy;
+
+    /// Policy named "reservoir", "least_novel" or "grid", false if the name is unknown.
+    bool set_policy(const std::string& name);
+    /// max_size <= 0 leaves the archive unbounded. cell_size is the side of the cells of GRID_DEDUP.
+    void set_limits(int max_size, double cell_size){this->max_size = max_size; this->cell_size = cell_size;}
+
+    /// Call after Novelty::update_archive added a descriptor with this novelty at the back of archive. Return the
+    /// slot it ends in: archive.size() - 1 if it was appended, the slot of the evicted descriptor, or -1 if it was
+    /// dropped. archive never exceeds the maximum size afterwards.
+    int on_insert(std::vector<Eigen::VectorXd>& archive, double novelty, const misc::RandNum::Ptr& rand_num);
+
+private:
+    size_t victim(const std::vector<Eigen::VectorXd>& archive, const misc::RandNum::Ptr& rand_num) const;
+    size_t least_novel(const std::vector<size_t>& candidates) const;
+
+    Policy policy = LEAST_NOVEL;
+    int max_size = 0;
+    double cell_size = 0.1;
+    // novelty of the descriptors of the archive when they were added, by slot
+    std::vector<double> novelties;
+    // number of descriptors ever added, for the reservoir
+    size_t nbr_seen = 0;
+};
+
+}
+
+#endif //ARCHIVE_EVICTION_HPP
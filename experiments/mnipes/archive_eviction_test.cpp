@@ -0,0 +1,76 @@
+#include "archive_eviction.hpp"
+#include "novelty_index.hpp"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+int main()
+{
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> unif(0,1);
+    are::misc::RandNum::Ptr rngen(new are::misc::RandNum(1));
+    const int max_size = 50;
+    int nbr_errors = 0;
+
+    for(const char* policy : {"reservoir","least_novel","grid"}){
+        are::ArchiveEviction eviction;
+        eviction.set_policy(policy);
+        eviction.set_limits(max_size,0.2);
+        // follows the archive by the returned slots, as NIPES does
+        are::NoveltyIndex index;
+        std::vector<Eigen::VectorXd> archive;
+        int errors = 0, nbr_dropped = 0;
+
+        for(int i = 0; i < 2000; i++){
+            Eigen::VectorXd desc(3);
+            for(int d = 0; d < 3; d++)
+                desc(d) = unif(gen);
+            std::vector<Eigen::VectorXd> before = archive;
+            archive.push_back(desc);
+            int slot = eviction.on_insert(archive,unif(gen),rngen);
+
+            if(archive.size() > static_cast<size_t>(max_size))
+                errors++;
+            if(slot < 0){
+                // dropped, the archive is left as it was
+                nbr_dropped++;
+                if(archive != before)
+                    errors++;
+                continue;
+            }
+            if(slot >= static_cast<int>(archive.size()) || archive[slot] != desc)
+                errors++;
+            // every other slot keeps its descriptor
+            for(size_t j = 0; j < before.size(); j++)
+                if(static_cast<int>(j) != slot && archive[j] != before[j])
+                    errors++;
+
+            if(static_cast<size_t>(slot) == before.size())
+                index.insert(desc);
+            else
+                index.replace(slot,desc);
+            if(index.size() != archive.size())
+                errors++;
+        }
+
+        // the index only saw the returned slots, it must hold the archive
+        are::NoveltyIndex rebuilt;
+        rebuilt.rebuild(archive);
+        for(int q = 0; q < 100; q++){
+            Eigen::VectorXd query(3);
+            for(int d = 0; d < 3; d++)
+                query(d) = unif(gen);
+            std::vector<double> distances, expected;
+            index.nearest_distances(query,15,distances);
+            rebuilt.nearest_distances(query,15,expected);
+            if(distances != expected)
+                errors++;
+        }
+
+        std::cout << policy << " : size " << archive.size() << ", " << nbr_dropped << " dropped, "
+                  << errors << " errors" << std::endl;
+        nbr_errors += errors;
+    }
+
+    return nbr_errors == 0 ? 0 : 1;
+}
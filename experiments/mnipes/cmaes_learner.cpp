@@ -1,5 +1,7 @@
 #include "cmaes_learner.hpp"
 
+#include <tbb/parallel_for.h>
+
 using namespace are;
 
 void CMAESLearner::init(std::vector<double> initial_point){
@@ -36,6 +38,30 @@ void CMAESLearner::init(std::vector<double> initial_point){
     _cma_strat->set_novelty_ratio(novelty_ratio);
     _cma_strat->set_novelty_decr(novelty_decr);
     _cma_strat->set_pop_stag_thres(pop_stag_thres);
+
+    std::string early_stopping_name = settings::getParameter<settings::String>(parameters,"#learnerEarlyStopping").value;
+    _early_stopping = EarlyStoppingRegistry::create(early_stopping_name);
+    if(!_early_stopping){
+        std::cerr << "ERROR: learnerEarlyStopping = " << early_stopping_name << " not recognized." << std::endl;
+        exit(1);
+    }
+    _early_stopping->set_in_process(true);
+    _early_stopping->init(parameters,pop_size);
+    _time_step = settings::getParameter<settings::Float>(parameters,"#timeStep").value;
+    _check_period = check_period(parameters);
+
+    std::string novelty_index = settings::getParameter<settings::String>(parameters,"#noveltyIndex").value;
+    if(!_novelty_index.set_mode(novelty_index,settings::getParameter<settings::Double>(parameters,"#noveltyIndexEpsilon").value)){
+        std::cerr << "ERROR: noveltyIndex = " << novelty_index << " not recognized." << std::endl;
+        exit(1);
+    }
+    std::string archive_eviction = settings::getParameter<settings::String>(parameters,"#archiveEviction").value;
+    if(!_archive_eviction.set_policy(archive_eviction)){
+        std::cerr << "ERROR: archiveEviction = " << archive_eviction << " not recognized." << std::endl;
+        exit(1);
+    }
+    _archive_eviction.set_limits(settings::getParameter<settings::Integer>(parameters,"#archiveMaxSize").value,
+                                 settings::getParameter<settings::Double>(parameters,"#archiveCellSize").value);
 }
 
 void CMAESLearner::update_pop_info(const std::vector<double> &obj, const Eigen::VectorXd &desc){
@@ -43,10 +69,31 @@ void CMAESLearner::update_pop_info(const std::vector<double> &obj, const Eigen::
     for(unsigned i = 0; i < _population[_counter-1].rows(); i++)
         ind.genome.push_back(std::tanh(_population[_counter-1](i)));
     ind.objectives = obj;
-    ind.descriptor.resize(desc.rows());
-    for(int i = 0; i < desc.rows(); i++)
-        ind.descriptor[i] = desc(i);
+    ind.descriptor.assign(desc.data(),desc.data() + desc.rows());
     _cma_strat->add_individual(ind);
+
+    if(_pop_descriptors.rows() != desc.rows() || _pop_descriptors.cols() != static_cast<Eigen::Index>(_population.size()))
+        _pop_descriptors.resize(desc.rows(),_population.size());
+    _pop_descriptors.col(_counter-1) = desc;
+
+    _early_stopping->on_eval_end(_eval_context,obj[0],_best_fitness);
+    _pop_contexts.push_back(_eval_context);
+    _pop_fitnesses.push_back(obj[0]);
+}
+
+bool CMAESLearner::early_stop(const Environment::Ptr &env, const Individual::Ptr &ind, double sim_time){
+    // the learner is not initialised for a body without actuators
+    if(!_early_stopping)
+        return false;
+    // the simulation halts a few ticks after the first stop request
+    if(_eval_context.stop_requested)
+        return true;
+    if(!_eval_context.check_due(sim_time,_check_period,_time_step))
+        return false;
+    _eval_context.stop_requested = _early_stopping->should_stop(_eval_context,sim_time,FitnessProbe(env,ind));
+    _eval_context.policy_stopped = _eval_context.stop_requested;
+    _eval_context.tick++;
+    return _eval_context.stop_requested;
 }
 
 void CMAESLearner::iterate(){
@@ -56,30 +103,38 @@ void CMAESLearner::iterate(){
             Novelty::k_value = _population.size()/2;
         else Novelty::k_value = settings::getParameter<settings::Integer>(parameters,"#kValue").value;
 
-        std::vector<Eigen::VectorXd> pop_desc;
-        for(const auto& ind : _cma_strat->get_population()){
-            Eigen::VectorXd desc(ind.descriptor.size());
-            for(int i = 0; i < ind.descriptor.size(); i++)
-                desc(i) = ind.descriptor[i];
-            pop_desc.push_back(desc);
-        }
-        //compute novelty
-        for(auto& ind : _cma_strat->access_population()){
-            Eigen::VectorXd ind_desc(ind.descriptor.size());
-            for(int i = 0; i < ind.descriptor.size(); i++)
-                ind_desc(i) = ind.descriptor[i];
-
-            double ind_nov = Novelty::sparseness(Novelty::distances(ind_desc,_novelty_archive,pop_desc));
-            ind.objectives.push_back(ind_nov);
+        // the columns are filled by update_pop_info, in the order of the population
+        auto& population = _cma_strat->access_population();
+        if(_pop_descriptors.cols() != static_cast<Eigen::Index>(population.size())){
+            _pop_descriptors.resize(population.empty() ? 0 : population[0].descriptor.size(),population.size());
+            for(size_t i = 0; i < population.size(); i++)
+                _pop_descriptors.col(i) = Eigen::Map<const Eigen::VectorXd>(population[i].descriptor.data(),population[i].descriptor.size());
         }
+        if(_novelty_index.size() != _novelty_archive.size())
+            _novelty_index.rebuild(_novelty_archive);
+        //compute novelty, in parallel as it only reads the archive
+        std::vector<double> novelties(population.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0,population.size()),[&](const tbb::blocked_range<size_t>& range){
+            for(size_t i = range.begin(); i < range.end(); i++)
+                novelties[i] = _novelty_index.sparseness(_pop_descriptors.col(i),_pop_descriptors,Novelty::k_value);
+        });
+        for(size_t i = 0; i < population.size(); i++)
+            population[i].objectives.push_back(novelties[i]);
 
         //update archive
-        for(const auto& ind : _cma_strat->get_population()){
-            Eigen::VectorXd ind_desc(ind.descriptor.size());
-            for(int i = 0; i < ind.descriptor.size(); i++)
-                ind_desc(i) = ind.descriptor[i];
-            double ind_nov = ind.objectives.back();
-            Novelty::update_archive(ind_desc,ind_nov,_novelty_archive,_rand_num);
+        for(size_t i = 0; i < population.size(); i++){
+            double ind_nov = population[i].objectives.back();
+            size_t archive_size = _novelty_archive.size();
+            Novelty::update_archive(_pop_descriptors.col(i),ind_nov,_novelty_archive,_rand_num);
+            if(_novelty_archive.size() == archive_size)
+                continue;
+            bool index_synced = _novelty_index.size() == archive_size;
+            int slot = _archive_eviction.on_insert(_novelty_archive,ind_nov,_rand_num);
+            if(slot < 0 || !index_synced)
+                continue;
+            if(static_cast<size_t>(slot) == archive_size)
+                _novelty_index.insert(_novelty_archive.back());
+            else _novelty_index.replace(slot,_novelty_archive[slot]);
         }
     }
     /**/
@@ -120,6 +175,13 @@ bool CMAESLearner::step(){
     if(_counter < _population.size())
         return false;
 
+    std::vector<EvalResult> results;
+    for(size_t i = 0; i < _pop_contexts.size(); i++)
+        results.push_back({&_pop_contexts[i],_pop_fitnesses[i]});
+    _early_stopping->on_epoch(results,_generation,_best_fitness);
+    _pop_contexts.clear();
+    _pop_fitnesses.clear();
+
     iterate();
     _archive.emplace(_generation,_cma_strat->get_population());
 
@@ -183,6 +245,10 @@ std::pair<std::vector<double>,std::vector<double>> CMAESLearner::update_ctrl(Con
     _counter++;
     _nbr_eval++;
 
+    _early_stopping->prepare_individual(_eval_context);
+    _eval_context.start();
+    _early_stopping->on_eval_start(_eval_context);
+
     return std::make_pair(weights,bias);
 
 }
@@ -9,6 +9,9 @@
 #include "ARE/nn2/NN2Control.hpp"
 #include "ARE/nn2/NN2Settings.hpp"
 #include "ARE/misc/RandNum.h"
+#include "early_stopping.hpp"
+#include "novelty_index.hpp"
+#include "archive_eviction.hpp"
 
 namespace are {
 
@@ -45,6 +48,10 @@ public:
 
     void update_pop_info(const std::vector<double>& obj, const Eigen::VectorXd &desc = Eigen::VectorXd::Zero(1));
 
+    /// Called at every tick of the evaluation of the current controller, true if it can be stopped.
+    /// The references are the ones of this learner only: controllers of different bodies are not comparable.
+    bool early_stop(const Environment::Ptr& env, const Individual::Ptr& ind, double sim_time);
+
     void set_randNum(const misc::RandNum::Ptr& rn){_rand_num = rn;}
     int get_nbr_eval(){return _nbr_eval;}
 
@@ -78,7 +85,21 @@ protected:
     bool _is_finish = false;
     archive_t _archive;
     std::vector<Eigen::VectorXd> _novelty_archive;
+    // descriptors of the evaluated controllers of the generation, one column per evaluation
+    Eigen::MatrixXd _pop_descriptors;
+    NoveltyIndex _novelty_index;
+    ArchiveEviction _archive_eviction;
     int nbr_dropped_eval = 0;
+
+    // #learnerEarlyStopping, run in the simulator process with the learner
+    EarlyStoppingPolicy::Ptr _early_stopping;
+    EvalContext _eval_context;
+    float _time_step;
+    double _check_period;
+    double _best_fitness = -__DBL_MAX__;
+    // the evaluations of the current generation, for the policy epoch
+    std::vector<EvalContext> _pop_contexts;
+    std::vector<double> _pop_fitnesses;
 };
 
 }//are
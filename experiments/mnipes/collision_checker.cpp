@@ -0,0 +1,90 @@
+#include "collision_checker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace are::sim;
+
+void CollisionChecker::set_obstacles(const std::vector<std::string> &names){
+    obstacles.clear();
+    for(const std::string& name : names){
+        int handle = simGetObjectHandle(name.c_str());
+        if(handle < 0){
+            std::cerr << "CollisionChecker: no object named " << name << " in the scene." << std::endl;
+            continue;
+        }
+        obstacles.push_back(make_part(handle));
+    }
+    robot_handle = -1;
+}
+
+void CollisionChecker::set_robot(int robot){
+    robot_handle = robot;
+    parts.clear();
+    int nbr_handles;
+    int* handles = simGetObjectsInTree(robot,sim_object_shape_type,0,&nbr_handles);
+    for(int i = 0; i < nbr_handles; i++)
+        parts.push_back(make_part(handles[i]));
+    simReleaseBuffer(reinterpret_cast<simChar*>(handles));
+}
+
+CollisionChecker::Part CollisionChecker::make_part(int handle){
+    Part part = {handle,0,{0,0,0}};
+    for(int j = 0; j < 3; j++){
+        float min, max;
+        simGetObjectFloatParameter(handle,sim_objfloatparam_objbbox_min_x + j,&min);
+        simGetObjectFloatParameter(handle,sim_objfloatparam_objbbox_max_x + j,&max);
+        float extent = std::max(std::fabs(min),std::fabs(max));
+        part.radius += extent*extent;
+    }
+    part.radius = std::sqrt(part.radius);
+    return part;
+}
+
+bool CollisionChecker::sphere_box(const float *center, float radius, const Bounds &box){
+    float dist = 0;
+    for(int j = 0; j < 3; j++){
+        float d = std::max(box.min[j] - center[j],std::max(0.f,center[j] - box.max[j]));
+        dist += d*d;
+    }
+    return dist <= radius*radius;
+}
+
+int CollisionChecker::count_colliding_obstacles(int robot){
+    if(robot != robot_handle)
+        set_robot(robot);
+
+    // bounds of the whole robot
+    Bounds robot_bounds = {{1e30f,1e30f,1e30f},{-1e30f,-1e30f,-1e30f}};
+    for(Part& part : parts){
+        simGetObjectPosition(part.handle,-1,part.position);
+        for(int j = 0; j < 3; j++){
+            robot_bounds.min[j] = std::min(robot_bounds.min[j],part.position[j] - part.radius);
+            robot_bounds.max[j] = std::max(robot_bounds.max[j],part.position[j] + part.radius);
+        }
+    }
+
+    int nbr_collisions = 0;
+    for(Part& obstacle : obstacles){
+        // obstacles may be pushed, their positions are read at each check
+        simGetObjectPosition(obstacle.handle,-1,obstacle.position);
+        Bounds box;
+        bool robot_overlap = true;
+        for(int j = 0; j < 3; j++){
+            box.min[j] = obstacle.position[j] - obstacle.radius;
+            box.max[j] = obstacle.position[j] + obstacle.radius;
+            robot_overlap = robot_overlap && robot_bounds.min[j] <= box.max[j] && box.min[j] <= robot_bounds.max[j];
+        }
+        if(!robot_overlap)
+            continue;
+
+        for(const Part& part : parts){
+            if(sphere_box(part.position,part.radius,box) && simCheckCollision(part.handle,obstacle.handle) > 0){
+                nbr_collisions++;
+                break;
+            }
+        }
+    }
+    return nbr_collisions;
+}
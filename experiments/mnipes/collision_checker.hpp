@@ -0,0 +1,62 @@
+#ifndef COLLISION_CHECKER_HPP
+#define COLLISION_CHECKER_HPP
+
+#if defined (VREP)
+#include "v_repLib.h"
+#elif defined (COPPELIASIM)
+#include "simLib.h"
+#elif defined (STANDIN_SIM)
+#include "standin_sim.h"
+#endif
+
+#include <string>
+#include <vector>
+
+namespace are {
+
+namespace sim{
+
+/**
+ * @brief Counts the obstacles a robot collides with. Handles are resolved once: the obstacles in set_obstacles(),
+ * the parts of the robot the first time a robot is checked. Each tick, the bounding spheres of the parts are
+ * tested against the bounding boxes of the obstacles and only the overlapping pairs go to simCheckCollision.
+ */
+class CollisionChecker
+{
+public:
+    /// Resolve the handles of the obstacles by name, the missing ones are skipped.
+    void set_obstacles(const std::vector<std::string>& names);
+    /// Forget the robot, its tree is fetched again at the next check.
+    void reset_robot(){robot_handle = -1;}
+
+    /// Number of obstacles colliding with the robot of main handle robot.
+    int count_colliding_obstacles(int robot);
+
+private:
+    typedef struct Bounds{
+        float min[3];
+        float max[3];
+    }Bounds;
+
+    typedef struct Part{
+        int handle;
+        // radius of the sphere centered on the origin of the object that contains its bounding box
+        float radius;
+        float position[3];
+    }Part;
+
+    void set_robot(int robot);
+    /// The sphere bounds the object whatever its orientation: only the positions are read at each tick.
+    static Part make_part(int handle);
+    static bool sphere_box(const float* center, float radius, const Bounds& box);
+
+    std::vector<Part> obstacles;
+    int robot_handle = -1;
+    std::vector<Part> parts;
+};
+
+} //sim
+
+} //are
+
+#endif //COLLISION_CHECKER_HPP
@@ -0,0 +1,241 @@
+#include "distance_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ARE_X86_KERNELS
+#endif
+
+using namespace are;
+
+namespace {
+
+typedef void (*squared_distances_t)(const double*, const double*, size_t, size_t, size_t, double*);
+typedef void (*hamming_distances_t)(const uint64_t*, const uint64_t*, size_t, size_t, uint32_t*);
+
+// fused as the vector versions, every version gives the same distances to the last bit
+void squared_distances_scalar(const double* query, const double* block, size_t dim, size_t n, size_t stride, double* out){
+    std::fill(out,out + n,0.);
+    for(size_t d = 0; d < dim; d++){
+        const double* row = block + d*stride;
+        for(size_t i = 0; i < n; i++){
+            double diff = row[i] - query[d];
+            out[i] = std::fma(diff,diff,out[i]);
+        }
+    }
+}
+
+void hamming_distances_scalar(const uint64_t* query, const uint64_t* block, size_t nbr_words, size_t n, uint32_t* out){
+    for(size_t i = 0; i < n; i++){
+        uint32_t dist = 0;
+        for(size_t w = 0; w < nbr_words; w++)
+            dist += __builtin_popcountll(query[w] ^ block[i*nbr_words + w]);
+        out[i] = dist;
+    }
+}
+
+#ifdef ARE_X86_KERNELS
+
+// 16 points at a time, the coordinates of each are summed over the dimensions in registers
+__attribute__((target("avx2,fma")))
+void squared_distances_avx2(const double* query, const double* block, size_t dim, size_t n, size_t stride, double* out){
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16){
+        __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+        __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+        for(size_t d = 0; d < dim; d++){
+            const double* row = block + d*stride + i;
+            __m256d q = _mm256_set1_pd(query[d]);
+            __m256d diff0 = _mm256_sub_pd(_mm256_loadu_pd(row),q);
+            __m256d diff1 = _mm256_sub_pd(_mm256_loadu_pd(row + 4),q);
+            __m256d diff2 = _mm256_sub_pd(_mm256_loadu_pd(row + 8),q);
+            __m256d diff3 = _mm256_sub_pd(_mm256_loadu_pd(row + 12),q);
+            acc0 = _mm256_fmadd_pd(diff0,diff0,acc0);
+            acc1 = _mm256_fmadd_pd(diff1,diff1,acc1);
+            acc2 = _mm256_fmadd_pd(diff2,diff2,acc2);
+            acc3 = _mm256_fmadd_pd(diff3,diff3,acc3);
+        }
+        _mm256_storeu_pd(out + i,acc0);
+        _mm256_storeu_pd(out + i + 4,acc1);
+        _mm256_storeu_pd(out + i + 8,acc2);
+        _mm256_storeu_pd(out + i + 12,acc3);
+    }
+    for(; i + 4 <= n; i += 4){
+        __m256d acc = _mm256_setzero_pd();
+        for(size_t d = 0; d < dim; d++){
+            __m256d diff = _mm256_sub_pd(_mm256_loadu_pd(block + d*stride + i),_mm256_set1_pd(query[d]));
+            acc = _mm256_fmadd_pd(diff,diff,acc);
+        }
+        _mm256_storeu_pd(out + i,acc);
+    }
+    if(i < n)
+        squared_distances_scalar(query,block + i,dim,n - i,stride,out + i);
+}
+
+__attribute__((target("avx512f")))
+void squared_distances_avx512(const double* query, const double* block, size_t dim, size_t n, size_t stride, double* out){
+    size_t i = 0;
+    for(; i + 32 <= n; i += 32){
+        __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+        __m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+        for(size_t d = 0; d < dim; d++){
+            const double* row = block + d*stride + i;
+            __m512d q = _mm512_set1_pd(query[d]);
+            __m512d diff0 = _mm512_sub_pd(_mm512_loadu_pd(row),q);
+            __m512d diff1 = _mm512_sub_pd(_mm512_loadu_pd(row + 8),q);
+            __m512d diff2 = _mm512_sub_pd(_mm512_loadu_pd(row + 16),q);
+            __m512d diff3 = _mm512_sub_pd(_mm512_loadu_pd(row + 24),q);
+            acc0 = _mm512_fmadd_pd(diff0,diff0,acc0);
+            acc1 = _mm512_fmadd_pd(diff1,diff1,acc1);
+            acc2 = _mm512_fmadd_pd(diff2,diff2,acc2);
+            acc3 = _mm512_fmadd_pd(diff3,diff3,acc3);
+        }
+        _mm512_storeu_pd(out + i,acc0);
+        _mm512_storeu_pd(out + i + 8,acc1);
+        _mm512_storeu_pd(out + i + 16,acc2);
+        _mm512_storeu_pd(out + i + 24,acc3);
+    }
+    // the last points are loaded under a mask
+    for(; i < n; i += 8){
+        __mmask8 mask = n - i >= 8 ? 0xFF : static_cast<__mmask8>((1u << (n - i)) - 1);
+        __m512d acc = _mm512_setzero_pd();
+        for(size_t d = 0; d < dim; d++){
+            __m512d diff = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask,block + d*stride + i),_mm512_set1_pd(query[d]));
+            acc = _mm512_maskz_fmadd_pd(mask,diff,diff,acc);
+        }
+        _mm512_mask_storeu_pd(out + i,mask,acc);
+    }
+}
+
+// same loop, compiled to the popcnt instruction instead of the bit tricks of the generic target
+__attribute__((target("popcnt")))
+void hamming_distances_popcnt(const uint64_t* query, const uint64_t* block, size_t nbr_words, size_t n, uint32_t* out){
+    if(nbr_words == 1){
+        uint64_t q = query[0];
+        for(size_t i = 0; i < n; i++)
+            out[i] = static_cast<uint32_t>(__builtin_popcountll(q ^ block[i]));
+        return;
+    }
+    for(size_t i = 0; i < n; i++){
+        uint32_t dist = 0;
+        for(size_t w = 0; w < nbr_words; w++)
+            dist += __builtin_popcountll(query[w] ^ block[i*nbr_words + w]);
+        out[i] = dist;
+    }
+}
+
+#endif //ARE_X86_KERNELS
+
+typedef struct Kernels{
+    squared_distances_t squared_distances = squared_distances_scalar;
+    hamming_distances_t hamming_distances = hamming_distances_scalar;
+    const char* isa = "scalar";
+
+    Kernels(){
+#ifdef ARE_X86_KERNELS
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f"))
+            set("avx512");
+        else if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            set("avx2");
+        if(__builtin_cpu_supports("popcnt"))
+            hamming_distances = hamming_distances_popcnt;
+#endif
+    }
+
+    bool set(const std::string& name){
+        if(name == "scalar"){
+            squared_distances = squared_distances_scalar;
+            hamming_distances = hamming_distances_scalar;
+            isa = "scalar";
+            return true;
+        }
+#ifdef ARE_X86_KERNELS
+        if(name == "avx512" && __builtin_cpu_supports("avx512f"))
+            squared_distances = squared_distances_avx512;
+        else if(name == "avx2" && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            squared_distances = squared_distances_avx2;
+        else return false;
+        isa = name == "avx512" ? "avx512" : "avx2";
+        if(__builtin_cpu_supports("popcnt"))
+            hamming_distances = hamming_distances_popcnt;
+        return true;
+#else
+        return false;
+#endif
+    }
+}Kernels;
+
+Kernels& kernels(){
+    static Kernels k;
+    return k;
+}
+
+}
+
+void are::squared_distances(const double *query, const double *block, size_t dim, size_t n, size_t stride, double *out){
+    kernels().squared_distances(query,block,dim,n,stride,out);
+}
+
+void are::hamming_distances(const uint64_t *query, const uint64_t *block, size_t nbr_words, size_t n, uint32_t *out){
+    kernels().hamming_distances(query,block,nbr_words,n,out);
+}
+
+const char* are::distance_kernels_isa(){
+    return kernels().isa;
+}
+
+bool are::set_distance_kernels_isa(const std::string &isa){
+    return kernels().set(isa);
+}
+
+void DescriptorBlock::reserve(size_t new_capacity){
+    if(new_capacity <= capacity)
+        return;
+    std::vector<double> new_data(dim*new_capacity);
+    for(size_t d = 0; d < dim; d++)
+        std::copy(data.begin() + d*capacity,data.begin() + d*capacity + nbr,new_data.begin() + d*new_capacity);
+    data.swap(new_data);
+    capacity = new_capacity;
+}
+
+void DescriptorBlock::assign(const std::vector<Eigen::VectorXd> &descriptors){
+    clear();
+    if(descriptors.empty())
+        return;
+    if(static_cast<size_t>(descriptors.front().size()) != dim){
+        dim = descriptors.front().size();
+        data.clear();
+        capacity = 0;
+    }
+    reserve(descriptors.size());
+    for(const Eigen::VectorXd& desc : descriptors)
+        push_back(desc);
+}
+
+void DescriptorBlock::push_back(const Eigen::Ref<const Eigen::VectorXd> &desc){
+    if(nbr == 0 && static_cast<size_t>(desc.size()) != dim){
+        dim = desc.size();
+        data.clear();
+        capacity = 0;
+    }
+    if(nbr == capacity)
+        reserve(std::max<size_t>(16,2*capacity));
+    nbr++;
+    set(nbr - 1,desc);
+}
+
+void DescriptorBlock::set(size_t i, const Eigen::Ref<const Eigen::VectorXd> &desc){
+    for(size_t d = 0; d < dim; d++)
+        data[d*capacity + i] = desc(d);
+}
+
+void DescriptorBlock::squared_distances(const Eigen::Ref<const Eigen::VectorXd> &query, std::vector<double> &out) const{
+    out.resize(nbr);
+    if(nbr == 0)
+        return;
+    // the query may be a column of a matrix, it is contiguous either way
+    are::squared_distances(query.data(),data.data(),dim,nbr,capacity,out.data());
+}
@@ -0,0 +1,60 @@
+#ifndef DISTANCE_KERNELS_HPP
+#define DISTANCE_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+
+namespace are {
+
+/**
+ * Distances from one descriptor to a block of descriptors, the innermost loop of the novelty.
+ * The AVX-512, AVX2 or POPCNT version is chosen at the first call from the instructions of the CPU,
+ * the scalar version runs on the others, so the binaries need no -march flag. All versions accumulate with fused
+ * multiply-adds in the same order, the distances do not depend on the CPU.
+ */
+
+/// Squared euclidean distances from query, of dim coordinates, to the n points of block, stored as structure
+/// of arrays: coordinate d of point i is block[d*stride + i]. out receives the n distances.
+void squared_distances(const double* query, const double* block, size_t dim, size_t n, size_t stride, double* out);
+
+/// Hamming distances from query, of nbr_words words, to the n bit strings of block stored one after another.
+void hamming_distances(const uint64_t* query, const uint64_t* block, size_t nbr_words, size_t n, uint32_t* out);
+
+/// "avx512", "avx2" or "scalar", the version of squared_distances used on this CPU.
+const char* distance_kernels_isa();
+/// Use the version named isa from now on, with the POPCNT version of hamming_distances unless isa is "scalar".
+/// False if the CPU lacks its instructions. For the tests, the best version is used otherwise.
+bool set_distance_kernels_isa(const std::string& isa);
+
+/**
+ * @brief Descriptors of the same dimension stored as structure of arrays for squared_distances.
+ * Descriptors are appended or replaced by position, as the slots of a novelty archive.
+ */
+class DescriptorBlock
+{
+public:
+    void assign(const std::vector<Eigen::VectorXd>& descriptors);
+    void push_back(const Eigen::Ref<const Eigen::VectorXd>& desc);
+    void set(size_t i, const Eigen::Ref<const Eigen::VectorXd>& desc);
+    void clear(){nbr = 0;}
+    size_t size() const {return nbr;}
+
+    /// Squared distances from query to the descriptors, in their order.
+    void squared_distances(const Eigen::Ref<const Eigen::VectorXd>& query, std::vector<double>& out) const;
+
+private:
+    void reserve(size_t new_capacity);
+
+    size_t dim = 0;
+    size_t nbr = 0;
+    size_t capacity = 0;
+    // coordinate d of descriptor i is data[d*capacity + i]
+    std::vector<double> data;
+};
+
+}
+
+#endif //DISTANCE_KERNELS_HPP
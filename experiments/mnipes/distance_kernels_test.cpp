@@ -0,0 +1,105 @@
+#include "distance_kernels.hpp"
+#include <bitset>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+typedef struct Case{
+    size_t dim;
+    size_t n;
+    size_t stride;
+    std::vector<double> query;
+    std::vector<double> block;
+}Case;
+
+typedef struct BitCase{
+    size_t nbr_words;
+    size_t n;
+    std::vector<uint64_t> query;
+    std::vector<uint64_t> block;
+}BitCase;
+
+int main()
+{
+    std::mt19937_64 gen(1);
+    std::uniform_real_distribution<double> unif(-3,3);
+
+    // sizes around the widths of the vector loops and of their tails
+    std::vector<Case> cases;
+    for(size_t dim : {1,3,7,64}){
+        for(size_t n : {0,1,3,4,5,8,15,16,17,31,32,33,100}){
+            Case c{dim,n,n + 3,std::vector<double>(dim),std::vector<double>(dim*(n + 3))};
+            for(double& x : c.query) x = unif(gen);
+            for(double& x : c.block) x = unif(gen);
+            cases.push_back(c);
+        }
+    }
+    std::vector<BitCase> bit_cases;
+    for(size_t nbr_words : {1,2,5}){
+        for(size_t n : {0,1,9,64}){
+            BitCase c{nbr_words,n,std::vector<uint64_t>(nbr_words),std::vector<uint64_t>(nbr_words*n)};
+            for(uint64_t& x : c.query) x = gen();
+            for(uint64_t& x : c.block) x = gen();
+            bit_cases.push_back(c);
+        }
+    }
+
+    int nbr_errors = 0;
+
+    // the scalar version is the reference, up to rounding it is the plain sum of squares
+    are::set_distance_kernels_isa("scalar");
+    std::vector<std::vector<double>> reference;
+    std::vector<std::vector<uint32_t>> bit_reference;
+    for(const Case& c : cases){
+        std::vector<double> out(c.n);
+        are::squared_distances(c.query.data(),c.block.data(),c.dim,c.n,c.stride,out.data());
+        for(size_t i = 0; i < c.n; i++){
+            double sum = 0;
+            for(size_t d = 0; d < c.dim; d++)
+                sum += (c.block[d*c.stride + i] - c.query[d])*(c.block[d*c.stride + i] - c.query[d]);
+            if(std::abs(sum - out[i]) > 1e-9*sum)
+                nbr_errors++;
+        }
+        reference.push_back(out);
+    }
+    for(const BitCase& c : bit_cases){
+        std::vector<uint32_t> out(c.n);
+        are::hamming_distances(c.query.data(),c.block.data(),c.nbr_words,c.n,out.data());
+        for(size_t i = 0; i < c.n; i++){
+            uint32_t dist = 0;
+            for(size_t w = 0; w < c.nbr_words; w++)
+                dist += std::bitset<64>(c.query[w] ^ c.block[i*c.nbr_words + w]).count();
+            if(dist != out[i])
+                nbr_errors++;
+        }
+        bit_reference.push_back(out);
+    }
+    std::cout << "scalar : " << nbr_errors << " errors" << std::endl;
+
+    // the vector versions give the same bits
+    for(const char* isa : {"avx2","avx512"}){
+        if(!are::set_distance_kernels_isa(isa)){
+            std::cout << isa << " : not supported by this CPU" << std::endl;
+            continue;
+        }
+        int errors = 0;
+        for(size_t j = 0; j < cases.size(); j++){
+            const Case& c = cases[j];
+            std::vector<double> out(c.n);
+            are::squared_distances(c.query.data(),c.block.data(),c.dim,c.n,c.stride,out.data());
+            if(std::memcmp(out.data(),reference[j].data(),c.n*sizeof(double)) != 0)
+                errors++;
+        }
+        for(size_t j = 0; j < bit_cases.size(); j++){
+            const BitCase& c = bit_cases[j];
+            std::vector<uint32_t> out(c.n);
+            are::hamming_distances(c.query.data(),c.block.data(),c.nbr_words,c.n,out.data());
+            if(out != bit_reference[j])
+                errors++;
+        }
+        std::cout << isa << " : " << errors << " errors" << std::endl;
+        nbr_errors += errors;
+    }
+
+    return nbr_errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,270 @@
+#include "early_stopping.hpp"
+#include "tools.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace are;
+
+std::map<std::string,EarlyStoppingRegistry::factory_t>& EarlyStoppingRegistry::factories()
+{
+    static std::map<std::string,factory_t> registered;
+    return registered;
+}
+
+bool EarlyStoppingRegistry::add(const std::string& name, const factory_t& factory)
+{
+    return factories().emplace(name,factory).second;
+}
+
+bool EarlyStoppingRegistry::contains(const std::string& name)
+{
+    return factories().find(name) != factories().end();
+}
+
+EarlyStoppingPolicy::Ptr EarlyStoppingRegistry::create(const std::string& name)
+{
+    auto it = factories().find(name);
+    if(it == factories().end())
+        return nullptr;
+    return it->second();
+}
+
+double are::check_period(const settings::ParametersMapPtr& param)
+{
+    float time_step = settings::getParameter<settings::Float>(param,"#timeStep").value;
+    return std::max(time_step, settings::getParameter<settings::Float>(param,"#checkPeriod").value);
+}
+
+double are::control_period(const settings::ParametersMapPtr& param)
+{
+    float time_step = settings::getParameter<settings::Float>(param,"#timeStep").value;
+    return std::max(time_step, settings::getParameter<settings::Float>(param,"#controlPeriod").value);
+}
+
+void EarlyStoppingRegistry::set_default_parameters()
+{
+    settings::defaults::parameters->emplace("#checkPeriod",new settings::Float(0));
+    settings::defaults::parameters->emplace("#controlPeriod",new settings::Float(0));
+    settings::defaults::parameters->emplace("#bestasrefGrace",new settings::Float(6.0));
+    settings::defaults::parameters->emplace("#halvingReductionFactor",new settings::Double(2.));
+    settings::defaults::parameters->emplace("#halvingWindow",new settings::Integer(0));
+    settings::defaults::parameters->emplace("#curveDownsampling",new settings::Integer(1));
+    settings::defaults::parameters->emplace("#curveQuantum",new settings::Double(1e-6));
+    settings::defaults::parameters->emplace("#extrapolationK",new settings::Integer(1));
+    settings::defaults::parameters->emplace("#extrapolationQuantile",new settings::Double(0.9));
+    settings::defaults::parameters->emplace("#extrapolationWindow",new settings::Integer(0));
+    settings::defaults::parameters->emplace("#extrapolationMinTime",new settings::Float(3.0));
+}
+
+REGISTER_EARLY_STOPPING_POLICY("standard", NoEarlyStopping)
+REGISTER_EARLY_STOPPING_POLICY("measure_ranks", NoEarlyStopping)
+REGISTER_EARLY_STOPPING_POLICY("halving", HalvingPolicy)
+REGISTER_EARLY_STOPPING_POLICY("bestasref", BestAsRefPolicy)
+
+
+void HalvingPolicy::init(const settings::ParametersMapPtr& param, int pop_size)
+{
+    EarlyStoppingPolicy::init(param,pop_size);
+    time_delta = check_period(parameters);
+    float max_eval_time = settings::getParameter<settings::Float>(parameters,"#maxEvalTime").value;
+    set_time_checkpoints(max_eval_time, pop_size, 2.0);
+
+    // Update fitness checkpoints after first iteration.
+    update_fitness_checkpoints = true;
+
+    // Set all fitness checkpoints to minus infinity so that the observed_fitnesse
+    // is computed for all controllers in first iteration.
+    std::fill_n(fitness_checkpoints, MAX_N_OF_HALVINGS, -1e20);
+}
+
+void HalvingPolicy::set_time_checkpoints(float max_eval_time, int pop_size, double eta)
+{
+    n_of_halvings = std::min(MAX_N_OF_HALVINGS, (int)(1.0 + log2((double)pop_size) / log2(eta)));
+    std::cout << "n_of_halvings: " << n_of_halvings << std::endl;
+    std::cout << "pop_size: " << pop_size << std::endl;
+
+    for (int i = 0; i < n_of_halvings; i++)
+    {
+        time_checkpoints[i] = pow(eta, -(n_of_halvings - 1 - i)) * max_eval_time;
+    }
+}
+
+void HalvingPolicy::prepare_individual(EvalContext& ctx)
+{
+    std::copy_n(fitness_checkpoints, n_of_halvings, ctx.fitness_checkpoints);
+}
+
+bool HalvingPolicy::should_stop(EvalContext& ctx, double runtime, const FitnessProbe& fitness)
+{
+    runtime += STOP_LATENCY;
+
+    // The checkpoints are met in increasing order, skip the ones already behind.
+    while (ctx.next_checkpoint < n_of_halvings && runtime >= time_checkpoints[ctx.next_checkpoint] + time_delta / 2)
+        ctx.next_checkpoint++;
+
+    // If current runtime is not the same as the next checkpoint runtime...
+    if (ctx.next_checkpoint >= n_of_halvings || runtime < time_checkpoints[ctx.next_checkpoint] - time_delta / 2)
+        return false;
+
+    int checkpointIndex = ctx.next_checkpoint++;
+
+    // save fitness and current used runtime
+    ctx.observed_fitnesses[checkpointIndex] = fitness();
+    ctx.consumed_runtime = runtime;
+
+    // check if should stop bc fitness lower than fitness checkpoint
+    return ctx.observed_fitnesses[checkpointIndex] < ctx.fitness_checkpoints[checkpointIndex];
+}
+
+void HalvingPolicy::get_checkpoints_from_results(const std::vector<EvalResult>& results)
+{
+    std::cout << "getfCheckpointsFromIndividuals(): " << std::endl;
+
+    size_t pop_size = results.size();
+    if (pop_size == 0)
+        return;
+    std::vector<std::vector<double>> fitnesses(n_of_halvings, std::vector<double>(pop_size));
+    for (size_t j = 0; j < pop_size; j++)
+    {
+        for (int i = 0; i < n_of_halvings; i++)
+        {
+            fitnesses[i][j] = results[j].context->observed_fitnesses[i];
+            std::cout << results[j].context->observed_fitnesses[i] << ",";
+        }
+        std::cout << std::endl;
+    }
+
+    for (int i = 0; i < n_of_halvings; i++)
+    {
+        std::sort(fitnesses[i].begin(), fitnesses[i].end());
+        int position = (int)((1.0 - pow(0.5, i + 1)) * (double)(pop_size - 1));
+        fitness_checkpoints[i] = fitnesses[i][position];
+    }
+    std::cout << std::endl;
+}
+
+void HalvingPolicy::on_epoch(const std::vector<EvalResult>& results, int generation, double& best_fitness)
+{
+    if (update_fitness_checkpoints)
+    {
+        get_checkpoints_from_results(results);
+        update_fitness_checkpoints = false;
+    }
+
+    if ((generation+1) % UPDATE_F_CHECKPOINTS_EVERY_N_GENS == 0)
+    {
+        std::cout << "Updating fitness checkpoints in next generation...";
+        update_fitness_checkpoints = true;
+        std::fill_n(fitness_checkpoints, MAX_N_OF_HALVINGS, -1e20);
+    }
+}
+
+
+void ThresholdCurvePolicy::init(const settings::ParametersMapPtr& param, int pop_size)
+{
+    EarlyStoppingPolicy::init(param,pop_size);
+    time_delta = check_period(parameters);
+    float max_eval_time = settings::getParameter<settings::Float>(parameters,"#maxEvalTime").value;
+    curve_stride = std::max(1, settings::getParameter<settings::Integer>(parameters, "#curveDownsampling").value);
+    curve_quantum = settings::getParameter<settings::Double>(parameters, "#curveQuantum").value;
+    threshold_filename = settings::getParameter<settings::String>(parameters,"#repository").value + "/" + curve_name + ".curve";
+
+    max_ticks = lround(max_eval_time / time_delta);
+    threshold = new_curve();
+    eval_threshold = new_curve();
+}
+
+void ThresholdCurvePolicy::set_threshold(const FitnessCurve& curve)
+{
+    threshold = curve;
+    threshold_changed = true;
+}
+
+void ThresholdCurvePolicy::prepare_individual(EvalContext& ctx)
+{
+    if (threshold_changed)
+    {
+        published_version++;
+        if (!in_process && !threshold.write_to_file(threshold_filename, published_version))
+            std::cerr << "Unable to write the threshold curve to " << threshold_filename << std::endl;
+        // quantized as the clients read it from the file, the stops do not depend on the instance type
+        eval_threshold = threshold;
+        eval_threshold.quantize();
+        loaded_version = published_version;
+        threshold_changed = false;
+    }
+    ctx.reference_version = published_version;
+    ctx.observed_curve = new_curve();
+}
+
+void ThresholdCurvePolicy::on_eval_start(EvalContext& ctx)
+{
+    if (ctx.reference_version != loaded_version)
+    {
+        // A newer version than the one of the individual may have been published meanwhile, it is as good.
+        loaded_version = eval_threshold.read_from_file(threshold_filename);
+        if (loaded_version == 0)
+            std::cerr << "Unable to read the threshold curve from " << threshold_filename << ", evaluating without threshold." << std::endl;
+    }
+    ctx.observed_curve.reserve(max_ticks);
+}
+
+bool ThresholdCurvePolicy::should_stop(EvalContext& ctx, double runtime, const FitnessProbe& fitness)
+{
+    unsigned long tick = ctx.tick;
+
+    // save fitness
+    ctx.observed_curve.record(tick, fitness());
+    ctx.consumed_runtime = runtime + STOP_LATENCY;
+
+    if (tick >= min_ticks && tick >= delay_ticks && fitness() < eval_threshold.at_tick(tick - delay_ticks))
+    {
+        std::cout << "Finish " << curve_name << ". " << std::endl;
+        return true;
+    }
+    return false;
+}
+
+
+void BestAsRefPolicy::init(const settings::ParametersMapPtr& param, int pop_size)
+{
+    ThresholdCurvePolicy::init(param,pop_size);
+    float bestasrefGrace = settings::getParameter<settings::Float>(parameters, "#bestasrefGrace").value;
+    delay_ticks = lround(bestasrefGrace / time_delta);
+    min_ticks = delay_ticks;
+
+    // Update fitness checkpoints after first iteration.
+    update_fitness_checkpoints = true;
+}
+
+void BestAsRefPolicy::on_eval_end(const EvalContext& ctx, double fitness, double& best_fitness)
+{
+    const double EPSILON = 0.0000001;
+    if (std::abs(fitness - best_fitness) < EPSILON)
+    {
+        std::cout << "We DO NOT relaxing best fitness refs if fitness is equal to bk." << std::endl;
+    }
+    else if (fitness > best_fitness)
+    {
+        const FitnessCurve& observed = ctx.observed_curve;
+        std::cout << "Updating fitnesses due to new best fitness." << std::endl;
+        std::cout << iterable_to_str(observed.get_samples().begin(), observed.get_samples().end()) << std::endl;
+        std::cout << "    -     " << std::endl;
+        std::cout << iterable_to_str(get_threshold().get_samples().begin(), get_threshold().get_samples().end()) << std::endl;
+        std::cout << "* * *" << std::endl;
+
+        best_fitness = fitness;
+        set_threshold(observed);
+    }
+}
+
+void BestAsRefPolicy::on_epoch(const std::vector<EvalResult>& results, int generation, double& best_fitness)
+{
+    if (update_fitness_checkpoints)
+    {
+        for (const auto& result : results)
+            on_eval_end(*result.context, result.fitness, best_fitness);
+        update_fitness_checkpoints = false;
+    }
+}
@@ -0,0 +1,228 @@
+#ifndef EARLY_STOPPING_HPP
+#define EARLY_STOPPING_HPP
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ARE/Individual.h"
+#include "ARE/Settings.h"
+#include "eval_context.hpp"
+#include "incremental_fitness.hpp"
+
+namespace are{
+
+/// The simulation halts the third time finish_eval() returns true, so decisions are taken 0.3 seconds ahead.
+constexpr double STOP_LATENCY = 0.3;
+
+/// Simulated time between two stopping checks, #checkPeriod or #timeStep if it is not set. The fitness curves have one tick per check.
+double check_period(const settings::ParametersMapPtr& param);
+/// Simulated time between two updates of the controllers, #controlPeriod or #timeStep if it is not set.
+double control_period(const settings::ParametersMapPtr& param);
+
+/**
+ * @brief Lazily computes the fitness of the running evaluation, at most once per tick.
+ */
+class FitnessProbe
+{
+public:
+    FitnessProbe(const Environment::Ptr& env, const Individual::Ptr& ind) : _env(env), _ind(ind){}
+
+    double operator()() const{
+        if(!_computed){
+            auto incremental = dynamic_cast<const IncrementalFitness*>(_env.get());
+            _value = incremental ? incremental->current_fitness() : _env->fitnessFunction(_ind)[0];
+            _computed = true;
+        }
+        return _value;
+    }
+
+private:
+    const Environment::Ptr& _env;
+    const Individual::Ptr& _ind;
+    mutable double _value = 0;
+    mutable bool _computed = false;
+};
+
+/**
+ * @brief A finished evaluation: the context it ran with and its final fitness.
+ */
+typedef struct EvalResult{
+    const EvalContext* context;
+    double fitness;
+}EvalResult;
+
+/**
+ * @brief Rule deciding whether an evaluation can be halted before its maximum evaluation time.
+ * The EA (NIPES, or the CMAESLearner of a M_NIPES morphology) calls the hooks in this order: prepare_individual() when an individual is created,
+ * on_eval_start() at the first tick, should_stop() at every tick, on_eval_end() when the
+ * evaluation is over and on_epoch() when the whole generation has been evaluated.
+ * The simulator side (on_eval_start and should_stop) may run in a client process: it must only rely on
+ * the EvalContext of the individual, the other hooks run where the EA lives.
+ */
+class EarlyStoppingPolicy
+{
+public:
+    typedef std::unique_ptr<EarlyStoppingPolicy> Ptr;
+
+    virtual ~EarlyStoppingPolicy(){}
+
+    virtual void init(const settings::ParametersMapPtr& param, int pop_size){parameters = param;}
+
+    /// Copy into the context the state the simulator side needs (fitness checkpoints, reference curve, ...).
+    virtual void prepare_individual(EvalContext& ctx){}
+
+    virtual void on_eval_start(EvalContext& ctx){}
+
+    /// Called at every tick of the simulation: must not allocate. runtime is the simulated time of the evaluation.
+    virtual bool should_stop(EvalContext& ctx, double runtime, const FitnessProbe& fitness) = 0;
+
+    /// best_fitness is the best fitness seen by the EA so far, policies ranking against it may update it.
+    virtual void on_eval_end(const EvalContext& ctx, double fitness, double& best_fitness){}
+
+    /// results holds the evaluations of the whole generation.
+    virtual void on_epoch(const std::vector<EvalResult>& results, int generation, double& best_fitness){}
+
+    /// If true, evaluations may end before the time budget and the consumed runtimes are accounted and logged.
+    virtual bool stops_early() const {return false;}
+
+    /// If true, the policy changes after each evaluation and prepare_individual() is called again on the
+    /// individuals not yet sent to a simulator, so that they get the new state.
+    virtual bool updates_per_evaluation() const {return false;}
+
+    /// Set when the evaluations run in the process of the EA: the state is then shared directly
+    /// instead of being published to the simulators.
+    void set_in_process(bool in_proc){in_process = in_proc;}
+
+protected:
+    settings::ParametersMapPtr parameters;
+    bool in_process = false;
+};
+
+/**
+ * @brief Maps a #subexperimentName to the early stopping policy to use.
+ * A new policy registers itself from its own translation unit with REGISTER_EARLY_STOPPING_POLICY.
+ */
+class EarlyStoppingRegistry
+{
+public:
+    typedef std::function<EarlyStoppingPolicy::Ptr()> factory_t;
+
+    static bool add(const std::string& name, const factory_t& factory);
+    static bool contains(const std::string& name);
+    static EarlyStoppingPolicy::Ptr create(const std::string& name);
+    /// Add the defaults of the parameters read by the registered policies.
+    static void set_default_parameters();
+
+private:
+    static std::map<std::string,factory_t>& factories();
+};
+
+#define ES_CONCAT_IMPL(a, b) a##b
+#define ES_CONCAT(a, b) ES_CONCAT_IMPL(a, b)
+#define REGISTER_EARLY_STOPPING_POLICY(name, policy_class) \
+    static const bool ES_CONCAT(early_stopping_registered_, __LINE__) = are::EarlyStoppingRegistry::add(name, \
+        []() -> are::EarlyStoppingPolicy::Ptr {return are::EarlyStoppingPolicy::Ptr(new policy_class);});
+
+/**
+ * @brief Evaluations always last the whole evaluation time ("standard" and "measure_ranks").
+ */
+class NoEarlyStopping : public EarlyStoppingPolicy
+{
+public:
+    bool should_stop(EvalContext&, double, const FitnessProbe&) override {return false;}
+};
+
+/**
+ * @brief Successive halving: at the runtime time_checkpoints[i] an evaluation is stopped if its fitness is below
+ * fitness_checkpoints[i], the fitness of the (1 - 0.5^(i+1)) quantile of the population at this runtime.
+ */
+class HalvingPolicy : public EarlyStoppingPolicy
+{
+public:
+    void init(const settings::ParametersMapPtr& param, int pop_size) override;
+    void prepare_individual(EvalContext& ctx) override;
+    bool should_stop(EvalContext& ctx, double runtime, const FitnessProbe& fitness) override;
+    void on_epoch(const std::vector<EvalResult>& results, int generation, double& best_fitness) override;
+    bool stops_early() const override {return true;}
+
+protected:
+    /// Place the checkpoints at max_eval_time * eta^-(n_of_halvings-1-i), one for each reduction of the population by eta.
+    void set_time_checkpoints(float max_eval_time, int pop_size, double eta);
+
+    int n_of_halvings;
+    float time_delta;
+    // In the first n_of_halvings positions, contains the runtimes in which we should check for minimum fitness.
+    double time_checkpoints[MAX_N_OF_HALVINGS];
+    double fitness_checkpoints[MAX_N_OF_HALVINGS];
+    bool update_fitness_checkpoints = false;
+
+private:
+    void get_checkpoints_from_results(const std::vector<EvalResult>& results);
+
+    static const int UPDATE_F_CHECKPOINTS_EVERY_N_GENS = 10;
+};
+
+/**
+ * @brief Stops an evaluation as soon as its fitness at tick t falls below threshold(t - delay_ticks), from min_ticks on.
+ * The threshold curve is not sent with each individual: when it changed, it is written once per generation to
+ * #repository/<curve_name>.curve with a new version, and the simulator side reloads it when an individual
+ * carries a version it has not loaded yet. In process, no file is written.
+ */
+class ThresholdCurvePolicy : public EarlyStoppingPolicy
+{
+public:
+    ThresholdCurvePolicy(const std::string& curve_name) : curve_name(curve_name){}
+
+    void init(const settings::ParametersMapPtr& param, int pop_size) override;
+    void prepare_individual(EvalContext& ctx) override;
+    void on_eval_start(EvalContext& ctx) override;
+    bool should_stop(EvalContext& ctx, double runtime, const FitnessProbe& fitness) override;
+    bool stops_early() const override {return true;}
+
+protected:
+    /// The new threshold is published to the simulators with the next generation.
+    void set_threshold(const FitnessCurve& curve);
+    const FitnessCurve& get_threshold() const {return threshold;}
+    FitnessCurve new_curve() const {return FitnessCurve(curve_stride, curve_quantum);}
+
+    float time_delta;
+    unsigned long delay_ticks = 0;
+    unsigned long min_ticks = 0;
+    unsigned long max_ticks;
+    unsigned int curve_stride;
+    double curve_quantum;
+
+private:
+    std::string curve_name;
+    std::string threshold_filename;
+    FitnessCurve threshold;
+    bool threshold_changed = false;
+    unsigned int published_version = 0;
+    // Threshold the evaluations compare to, as published with loaded_version.
+    FitnessCurve eval_threshold;
+    unsigned int loaded_version = 0;
+};
+
+/**
+ * @brief Best as reference: an evaluation is stopped as soon as its fitness falls below the fitness the best
+ * individual so far had bestasrefGrace seconds earlier.
+ */
+class BestAsRefPolicy : public ThresholdCurvePolicy
+{
+public:
+    BestAsRefPolicy() : ThresholdCurvePolicy("bestasref_reference"){}
+
+    void init(const settings::ParametersMapPtr& param, int pop_size) override;
+    void on_eval_end(const EvalContext& ctx, double fitness, double& best_fitness) override;
+    void on_epoch(const std::vector<EvalResult>& results, int generation, double& best_fitness) override;
+
+private:
+    bool update_fitness_checkpoints = false;
+};
+
+}
+
+#endif //EARLY_STOPPING_HPP
@@ -0,0 +1,71 @@
+#ifndef EVAL_CONTEXT_HPP
+#define EVAL_CONTEXT_HPP
+
+#include <cmath>
+
+#include "fitness_curve.hpp"
+
+#define MAX_N_OF_HALVINGS 20
+
+namespace are{
+
+/**
+ * @brief All the state an early stopping rule needs during one evaluation. It is part of the individual and is
+ * serialized with it, so a client stops an evaluation with the checkpoints and reference the server prepared
+ * and the server gets back what was observed.
+ */
+class EvalContext
+{
+public:
+    /// Reset the per-evaluation counters at the first tick of an evaluation.
+    void start(){
+        tick = 0;
+        stop_requested = false;
+        policy_stopped = false;
+        next_checkpoint = 0;
+        observed_curve.clear();
+    }
+
+    /// Whether a check falls at this runtime, the tick-th check being at (tick + 1)*check_period.
+    bool check_due(double runtime, double check_period, double time_step) const{
+        return runtime + time_step/2 >= (tick + 1)*check_period;
+    }
+
+    template<class archive>
+    void serialize(archive &arch, const unsigned int v)
+    {
+        arch & fitness_checkpoints;
+        arch & reference_version;
+        arch & record_curve;
+        arch & observed_fitnesses;
+        arch & observed_curve;
+        arch & consumed_runtime;
+        arch & stop_requested;
+        arch & policy_stopped;
+    }
+
+    // Prepared by the server before the evaluation.
+    double fitness_checkpoints[MAX_N_OF_HALVINGS] = {0};
+    // The reference curve itself is published once per generation, see ThresholdCurvePolicy.
+    unsigned int reference_version = 0;
+    // The fitness curve is recorded even if the policy does not need it.
+    bool record_curve = false;
+
+    // Observed by the simulator during the evaluation.
+    double observed_fitnesses[MAX_N_OF_HALVINGS] = {0};
+    FitnessCurve observed_curve;
+    double consumed_runtime = 0;
+
+    // Only meaningful while the evaluation runs.
+    unsigned long tick = 0;
+    // The simulation halts after finish_eval() returned true 3 times, the decision is latched meanwhile.
+    bool stop_requested = false;
+    // Sent back with the individual, the early stopping policy cut the evaluation short. An evaluation
+    // reaching #FTarget or the target position also stops early, but it completed.
+    bool policy_stopped = false;
+    int next_checkpoint = 0;
+};
+
+}
+
+#endif //EVAL_CONTEXT_HPP
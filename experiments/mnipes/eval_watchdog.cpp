@@ -0,0 +1,84 @@
+#include "eval_watchdog.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+using namespace are;
+
+EvalWatchdog::EvalWatchdog(double factor, double min_time) :
+    factor(factor), min_time(min_time)
+{
+    handler = [](double wall_time){
+        std::cerr << "EvalWatchdog: the evaluation has not finished after " << wall_time
+                  << " s, the simulator instance is considered stuck and exits." << std::endl;
+        std::_Exit(EXIT_FAILURE);
+    };
+}
+
+EvalWatchdog::~EvalWatchdog()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    if(thread.joinable())
+        thread.join();
+}
+
+void EvalWatchdog::start_eval(double sim_duration, double sim_time)
+{
+    start_sim_time = last_sim_time = sim_time;
+    start_wall_time = clock::now();
+    if(factor <= 0)
+        return;
+
+    double timeout = std::max(min_time, factor*slowdown*sim_duration);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        armed = true;
+        armed_at = start_wall_time;
+        deadline = start_wall_time + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(timeout));
+        // started with the first evaluation, so instances without a watchdog have no thread
+        if(!thread.joinable())
+            thread = std::thread(&EvalWatchdog::run,this);
+    }
+    cv.notify_all();
+}
+
+void EvalWatchdog::end_eval()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        armed = false;
+    }
+    cv.notify_all();
+
+    double simulated = last_sim_time - start_sim_time;
+    if(simulated <= 0)
+        return;
+    double wall_time = std::chrono::duration<double>(clock::now() - start_wall_time).count();
+    // the slowdown varies with the load of the node, recent evaluations weigh more
+    slowdown = measured ? 0.8*slowdown + 0.2*wall_time/simulated : wall_time/simulated;
+    measured = true;
+}
+
+void EvalWatchdog::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while(!stopping){
+        if(!armed){
+            cv.wait(lock);
+            continue;
+        }
+        clock::time_point current_deadline = deadline;
+        if(cv.wait_until(lock,current_deadline) == std::cv_status::timeout && armed && deadline == current_deadline){
+            armed = false;
+            double wall_time = std::chrono::duration<double>(clock::now() - armed_at).count();
+            lock.unlock();
+            handler(wall_time);
+            lock.lock();
+        }
+    }
+}
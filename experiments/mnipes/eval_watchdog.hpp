@@ -0,0 +1,73 @@
+#ifndef EVAL_WATCHDOG_HPP
+#define EVAL_WATCHDOG_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace are {
+
+/**
+ * @brief Thread ending the simulator instance when an evaluation takes far longer than expected, so the server
+ * sees a dead instance instead of waiting forever for the individual. The expected wall time of an evaluation
+ * is its simulated time times the slowdown measured on the previous evaluations of the instance.
+ * Only the clients of #instanceType 1 arm it: the server requeues the individual of a client that exits and
+ * starts a new instance, whereas a single instance has nobody to take the run over.
+ */
+class EvalWatchdog
+{
+public:
+    /// Called from the watchdog thread with the wall time the evaluation has taken.
+    typedef std::function<void(double)> handler_t;
+
+    /// factor <= 0 disables the watchdog. An evaluation is never given less than min_time wall seconds.
+    EvalWatchdog(double factor = 0, double min_time = 60);
+    ~EvalWatchdog();
+    EvalWatchdog(const EvalWatchdog&) = delete;
+    EvalWatchdog& operator=(const EvalWatchdog&) = delete;
+
+    void set_limits(double factor, double min_time){this->factor = factor; this->min_time = min_time;}
+    /// The default handler prints the delay and exits the process.
+    void set_handler(const handler_t& handler){this->handler = handler;}
+
+    /// At the first tick of an evaluation expected to simulate sim_duration seconds.
+    void start_eval(double sim_duration, double sim_time);
+    /// At each tick, only the simulator thread reads it.
+    void tick(double sim_time){last_sim_time = sim_time;}
+    /// Disarm the watchdog and update the slowdown with the evaluation.
+    void end_eval();
+
+    /// Wall seconds per simulated second, 1 until an evaluation is measured.
+    double get_slowdown() const {return slowdown;}
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    void run();
+
+    double factor;
+    double min_time;
+    handler_t handler;
+
+    // simulator thread only
+    double slowdown = 1;
+    bool measured = false;
+    double start_sim_time = 0;
+    double last_sim_time = 0;
+    clock::time_point start_wall_time;
+
+    // shared with the watchdog thread
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool armed = false;
+    bool stopping = false;
+    clock::time_point armed_at;
+    clock::time_point deadline;
+};
+
+}
+
+#endif //EVAL_WATCHDOG_HPP
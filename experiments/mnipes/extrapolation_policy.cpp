@@ -0,0 +1,62 @@
+#include "extrapolation_policy.hpp"
+
+#include <algorithm>
+#include <functional>
+
+using namespace are;
+
+REGISTER_EARLY_STOPPING_POLICY("extrapolation", ExtrapolationPolicy)
+
+void ExtrapolationPolicy::init(const settings::ParametersMapPtr& param, int pop_size)
+{
+    ThresholdCurvePolicy::init(param, pop_size);
+    k = std::max(1, settings::getParameter<settings::Integer>(parameters,"#extrapolationK").value);
+    quantile = settings::getParameter<settings::Double>(parameters,"#extrapolationQuantile").value;
+    int window = settings::getParameter<settings::Integer>(parameters,"#extrapolationWindow").value;
+    window_size = window > 0 ? window : pop_size;
+    float min_time = settings::getParameter<settings::Float>(parameters,"#extrapolationMinTime").value;
+    min_ticks = lround(min_time / time_delta);
+}
+
+void ExtrapolationPolicy::on_eval_end(const EvalContext& ctx, double fitness, double& best_fitness)
+{
+    // the fitness of a stopped evaluation is below its final fitness, the k-th best stays a lower bound
+    final_fitnesses.push_back(fitness);
+    if (final_fitnesses.size() > window_size)
+        final_fitnesses.pop_front();
+
+    // the gains can only be measured on evaluations the policy did not stop, the ones reaching the target completed
+    if (ctx.policy_stopped || ctx.observed_curve.empty())
+        return;
+
+    completed.push_back({ctx.observed_curve.get_samples(), fitness});
+    if (completed.size() > window_size)
+        completed.pop_front();
+}
+
+void ExtrapolationPolicy::on_epoch(const std::vector<EvalResult>& results, int generation, double& best_fitness)
+{
+    if (final_fitnesses.size() < k || completed.size() < MIN_CURVES)
+        return;
+
+    values.assign(final_fitnesses.begin(), final_fitnesses.end());
+    std::nth_element(values.begin(), values.begin() + (k - 1), values.end(), std::greater<double>());
+    double kth_best = values[k - 1];
+
+    // Fewer curves reach the late samples, the threshold ends where there are not enough of them.
+    FitnessCurve threshold = new_curve();
+    for (size_t i = 0;; i++)
+    {
+        values.clear();
+        for (const auto& curve : completed)
+            if (i < curve.samples.size())
+                values.push_back(curve.final_fitness - curve.samples[i]);
+        if (values.size() < MIN_CURVES)
+            break;
+        size_t position = (size_t)(quantile * (double)(values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + position, values.end());
+        threshold.record(i * curve_stride, kth_best - values[position]);
+    }
+    set_threshold(threshold);
+    std::cout << "Extrapolation threshold over " << threshold.size() << " samples, k-th best final fitness: " << kth_best << std::endl;
+}
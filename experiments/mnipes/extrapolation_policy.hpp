@@ -0,0 +1,46 @@
+#ifndef EXTRAPOLATION_POLICY_HPP
+#define EXTRAPOLATION_POLICY_HPP
+
+#include <deque>
+
+#include "early_stopping.hpp"
+
+namespace are{
+
+/**
+ * @brief Learning-curve extrapolation: an evaluation is stopped when even an optimistic prediction of its final fitness
+ * cannot reach the k-th best final fitness known. The prediction adds to the current fitness f(t) the
+ * #extrapolationQuantile quantile of the gains f(end) - f(t) of the last completed evaluations, so the rule makes no
+ * assumption on the shape of the curves. Since the k-th best and the gains only change with completed evaluations,
+ * the threshold curve kth_best - gain(t) is computed once per generation and published like the bestasref reference.
+ */
+class ExtrapolationPolicy : public ThresholdCurvePolicy
+{
+public:
+    ExtrapolationPolicy() : ThresholdCurvePolicy("extrapolation_threshold"){}
+
+    void init(const settings::ParametersMapPtr& param, int pop_size) override;
+    void on_eval_end(const EvalContext& ctx, double fitness, double& best_fitness) override;
+    void on_epoch(const std::vector<EvalResult>& results, int generation, double& best_fitness) override;
+
+private:
+    typedef struct CompletedCurve{
+        std::vector<double> samples;
+        double final_fitness;
+    }CompletedCurve;
+
+    // A gain is only estimated from at least this many curves.
+    static const size_t MIN_CURVES = 5;
+
+    size_t k;
+    double quantile;
+    size_t window_size;
+    std::deque<CompletedCurve> completed;
+    // fitnesses of the last evaluations, stopped or not
+    std::deque<double> final_fitnesses;
+    std::vector<double> values;
+};
+
+}
+
+#endif //EXTRAPOLATION_POLICY_HPP
@@ -1,4 +1,5 @@
 #include "simulatedER/mazeEnv.h"
+#include "incremental_maze_env.hpp"
 #include "obstacleAvoidance.hpp"
 #include "M_NIPES.hpp"
 #include "MNIPESLoggings.hpp"
@@ -9,7 +10,7 @@ extern "C" are::Environment::Ptr environmentFactory
     int env_type = are::settings::getParameter<are::settings::Integer>(param,"#envType").value;
     are::Environment::Ptr env;
     if(env_type == 0){
-        env.reset(new are::sim::MazeEnv);
+        env.reset(new are::sim::IncrementalMazeEnv);
         env->set_parameters(param);
     }
     else if(env_type == 1)
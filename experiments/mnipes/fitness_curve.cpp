@@ -0,0 +1,138 @@
+#include "fitness_curve.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace are;
+
+namespace {
+
+void put_varint(std::string& str, uint64_t value)
+{
+    while(value >= 0x80){
+        str.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    str.push_back(static_cast<char>(value));
+}
+
+bool get_varint(const std::string& str, size_t& pos, uint64_t& value)
+{
+    value = 0;
+    for(int shift = 0; shift < 64 && pos < str.size(); shift += 7){
+        uint8_t byte = static_cast<uint8_t>(str[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if(!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t value){return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);}
+int64_t unzigzag(uint64_t value){return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);}
+
+// the deltas of two quantized samples must fit in 64 bits
+const double MAX_QUANTIZED = 2305843009213693952.; // 2^61
+
+// llround is undefined out of the range of long long, as for the -1e20 sentinels or nan
+int64_t quantized_sample(double value, double quantum)
+{
+    double q = value / quantum;
+    if(std::isnan(q) || q <= -MAX_QUANTIZED)
+        return -static_cast<int64_t>(MAX_QUANTIZED);
+    if(q >= MAX_QUANTIZED)
+        return static_cast<int64_t>(MAX_QUANTIZED);
+    return std::llround(q);
+}
+
+}
+
+std::string FitnessCurve::encode() const
+{
+    std::string str;
+    str.reserve(16 + samples.size());
+    str.push_back(static_cast<char>(ENCODING_VERSION));
+    put_varint(str, stride);
+    char quantum_bytes[sizeof(double)];
+    std::memcpy(quantum_bytes, &quantum, sizeof(double));
+    str.append(quantum_bytes, sizeof(double));
+    put_varint(str, samples.size());
+
+    int64_t previous = 0;
+    for(double s : samples){
+        int64_t q = quantized_sample(s, quantum);
+        put_varint(str, zigzag(q - previous));
+        previous = q;
+    }
+    return str;
+}
+
+bool FitnessCurve::decode(const std::string& str)
+{
+    samples.clear();
+    if(str.size() < 2 + sizeof(double) || static_cast<unsigned char>(str[0]) != ENCODING_VERSION)
+        return false;
+
+    size_t pos = 1;
+    uint64_t value;
+    if(!get_varint(str, pos, value) || value == 0 || pos + sizeof(double) > str.size())
+        return false;
+    unsigned int new_stride = static_cast<unsigned int>(value);
+    double new_quantum;
+    std::memcpy(&new_quantum, str.data() + pos, sizeof(double));
+    pos += sizeof(double);
+    uint64_t nbr_samples;
+    if(!get_varint(str, pos, nbr_samples) || nbr_samples > str.size() - pos)
+        return false;
+
+    samples.reserve(nbr_samples);
+    int64_t q = 0;
+    for(uint64_t i = 0; i < nbr_samples; i++){
+        if(!get_varint(str, pos, value)){
+            samples.clear();
+            return false;
+        }
+        q += unzigzag(value);
+        samples.push_back(static_cast<double>(q) * new_quantum);
+    }
+    stride = new_stride;
+    quantum = new_quantum;
+    return true;
+}
+
+bool FitnessCurve::write_to_file(const std::string& filename, unsigned int version) const
+{
+    std::string str;
+    put_varint(str, version);
+    str += encode();
+
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream ofs(tmp_filename, std::ios::binary | std::ios::trunc);
+    if(!ofs)
+        return false;
+    ofs.write(str.data(), str.size());
+    ofs.close();
+    if(!ofs)
+        return false;
+    return std::rename(tmp_filename.c_str(), filename.c_str()) == 0;
+}
+
+unsigned int FitnessCurve::read_from_file(const std::string& filename)
+{
+    std::ifstream ifs(filename, std::ios::binary);
+    if(!ifs)
+        return 0;
+    std::stringstream sstr;
+    sstr << ifs.rdbuf();
+    std::string str = sstr.str();
+
+    size_t pos = 0;
+    uint64_t version;
+    if(!get_varint(str, pos, version) || !decode(str.substr(pos)))
+        return 0;
+    return static_cast<unsigned int>(version);
+}
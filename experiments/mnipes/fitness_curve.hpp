@@ -0,0 +1,86 @@
+#ifndef FITNESS_CURVE_HPP
+#define FITNESS_CURVE_HPP
+
+#include <cfloat>
+#include <string>
+#include <vector>
+
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/string.hpp>
+
+namespace are{
+
+/**
+ * @brief Fitness of an evaluation over time, one sample every stride ticks.
+ * The curve grows with the evaluation, so its length is only bounded by the evaluation time. It is encoded
+ * in binary as quantized deltas (multiples of quantum) written as zigzag varints, a slowly changing curve
+ * takes about one byte per sample. Samples beyond +-2^61 quanta, as the -1e20 sentinels, are clamped there and nan
+ * is taken as the lowest value.
+ */
+class FitnessCurve
+{
+public:
+    FitnessCurve(unsigned int stride = 1, double quantum = 1e-6) : stride(stride), quantum(quantum){}
+
+    void clear(){samples.clear();}
+    /// Reserve the samples of an evaluation of nbr_ticks ticks, so record() does not allocate.
+    void reserve(unsigned long nbr_ticks){samples.reserve(nbr_ticks / stride + 1);}
+
+    /// Record the fitness at this tick. Only the ticks multiple of stride are kept.
+    void record(unsigned long tick, double fitness){
+        if(tick % stride != 0)
+            return;
+        size_t index = tick / stride;
+        if(index >= samples.size())
+            samples.resize(index + 1, fitness);
+        samples[index] = fitness;
+    }
+
+    /// Fitness at this tick, held from the last sample. -DBL_MAX if the curve does not reach it.
+    double at_tick(unsigned long tick) const{
+        size_t index = tick / stride;
+        return index < samples.size() ? samples[index] : -DBL_MAX;
+    }
+
+    bool empty() const {return samples.empty();}
+    size_t size() const {return samples.size();}
+    const std::vector<double>& get_samples() const {return samples;}
+
+    std::string encode() const;
+    /// Round the samples as encode() does, the curve is then the one a reader of the encoding gets.
+    void quantize(){decode(encode());}
+    /// Return false, leaving the curve empty, if str is not a curve.
+    bool decode(const std::string& str);
+
+    /// Write the curve to filename through a temporary file, readers never see a partial curve.
+    bool write_to_file(const std::string& filename, unsigned int version) const;
+    /// Return the version written with the curve, 0 if the file cannot be read.
+    unsigned int read_from_file(const std::string& filename);
+
+    friend class boost::serialization::access;
+    template<class archive>
+    void save(archive &arch, const unsigned int v) const
+    {
+        std::string str = encode();
+        arch & str;
+    }
+    template<class archive>
+    void load(archive &arch, const unsigned int v)
+    {
+        std::string str;
+        arch & str;
+        decode(str);
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+private:
+    static const unsigned char ENCODING_VERSION = 1;
+
+    unsigned int stride;
+    double quantum;
+    std::vector<double> samples;
+};
+
+}
+
+#endif //FITNESS_CURVE_HPP
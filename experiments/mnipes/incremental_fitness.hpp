@@ -0,0 +1,20 @@
+#ifndef INCREMENTAL_FITNESS_HPP
+#define INCREMENTAL_FITNESS_HPP
+
+namespace are {
+
+/**
+ * @brief Environment keeping the fitness of the running evaluation up to date in updateEnv,
+ * so that it can be read at every tick without calling fitnessFunction.
+ */
+class IncrementalFitness
+{
+public:
+    virtual ~IncrementalFitness(){}
+    /// Same value as fitnessFunction(ind)[0] after the last updateEnv.
+    virtual double current_fitness() const = 0;
+};
+
+}
+
+#endif //INCREMENTAL_FITNESS_HPP
@@ -0,0 +1,28 @@
+#include "incremental_maze_env.hpp"
+
+#include <cmath>
+
+using namespace are::sim;
+
+void IncrementalMazeEnv::init(){
+    MazeEnv::init();
+    target[0] = settings::getParameter<settings::Double>(parameters,"#target_x").value;
+    target[1] = settings::getParameter<settings::Double>(parameters,"#target_y").value;
+    target[2] = settings::getParameter<settings::Double>(parameters,"#target_z").value;
+    double arena_size = settings::getParameter<settings::Double>(parameters,"#arenaSize").value;
+    max_distance = std::sqrt(2*arena_size*arena_size);
+    fitness = 0;
+}
+
+float IncrementalMazeEnv::updateEnv(float simulationTime, const Morphology::Ptr &morph){
+    float res = MazeEnv::updateEnv(simulationTime,morph);
+    double dist = 0;
+    for(int i = 0; i < 3; i++)
+        dist += (final_position[i] - target[i])*(final_position[i] - target[i]);
+    fitness = 1 - std::sqrt(dist)/max_distance;
+    if(std::isnan(fitness) || fitness < 0)
+        fitness = 0;
+    else if(fitness > 1)
+        fitness = 1;
+    return res;
+}
@@ -0,0 +1,32 @@
+#ifndef INCREMENTAL_MAZE_ENV_HPP
+#define INCREMENTAL_MAZE_ENV_HPP
+
+#include "simulatedER/mazeEnv.h"
+#include "incremental_fitness.hpp"
+
+namespace are {
+
+namespace sim{
+
+/**
+ * @brief MazeEnv whose fitness, 1 minus the distance of the robot to the target normalised by the diagonal
+ * of the arena, is updated at each updateEnv.
+ */
+class IncrementalMazeEnv : public MazeEnv, public IncrementalFitness
+{
+public:
+    void init() override;
+    float updateEnv(float simulationTime, const Morphology::Ptr &morph) override;
+    double current_fitness() const override {return fitness;}
+
+private:
+    double target[3];
+    double max_distance = 1;
+    double fitness = 0;
+};
+
+} //sim
+
+} //are
+
+#endif //INCREMENTAL_MAZE_ENV_HPP
@@ -0,0 +1,190 @@
+#include "novelty_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace are;
+
+bool NoveltyIndex::set_mode(const std::string &name, double epsilon){
+    if(name == "brute_force")
+        mode = BRUTE_FORCE;
+    else if(name == "exact")
+        mode = EXACT;
+    else if(name == "approximate")
+        mode = APPROXIMATE;
+    else return false;
+    this->epsilon = epsilon;
+    build();
+    return true;
+}
+
+void NoveltyIndex::insert(const Eigen::VectorXd &point){
+    points.push_back(point);
+    alive.push_back(true);
+    slots.push_back(points.size() - 1);
+    order.push_back(points.size() - 1);
+    if(mode == BRUTE_FORCE)
+        block.push_back(point);
+    if(needs_build())
+        build();
+}
+
+void NoveltyIndex::replace(size_t slot, const Eigen::VectorXd &point){
+    alive[slots[slot]] = false;
+    nbr_dead++;
+    points.push_back(point);
+    alive.push_back(true);
+    slots[slot] = points.size() - 1;
+    order.push_back(points.size() - 1);
+    if(mode == BRUTE_FORCE)
+        block.set(slot,point);
+    if(needs_build())
+        build();
+}
+
+void NoveltyIndex::rebuild(const std::vector<Eigen::VectorXd> &new_points){
+    points = new_points;
+    alive.assign(points.size(),true);
+    nbr_dead = 0;
+    slots.resize(points.size());
+    for(size_t i = 0; i < slots.size(); i++)
+        slots[i] = i;
+    order = slots;
+    build();
+}
+
+bool NoveltyIndex::needs_build() const{
+    // a brute force index is compacted when the dead points are as many as the live ones
+    if(mode == BRUTE_FORCE)
+        return nbr_dead > slots.size();
+    return order.size() - nbr_indexed + nbr_dead > nbr_indexed/4 + LEAF_SIZE;
+}
+
+void NoveltyIndex::build(){
+    if(nbr_dead > 0){
+        std::vector<Eigen::VectorXd> live_points;
+        live_points.reserve(slots.size());
+        for(size_t &slot : slots){
+            live_points.push_back(std::move(points[slot]));
+            slot = live_points.size() - 1;
+        }
+        points.swap(live_points);
+        alive.assign(points.size(),true);
+        nbr_dead = 0;
+        order = slots;
+    }
+    nodes.clear();
+    nbr_indexed = 0;
+    block.clear();
+    if(mode == BRUTE_FORCE){
+        for(size_t slot : slots)
+            block.push_back(points[slot]);
+        return;
+    }
+    if(points.empty())
+        return;
+    nodes.reserve(2*points.size()/LEAF_SIZE + 1);
+    build(0,points.size());
+    nbr_indexed = points.size();
+}
+
+int NoveltyIndex::build(size_t begin, size_t end){
+    int node = static_cast<int>(nodes.size());
+    nodes.push_back({begin,end,0,-1,-1});
+    if(end - begin <= LEAF_SIZE)
+        return node;
+
+    // the first point is the vantage point, the others are split at the median of their distances to it
+    const Eigen::VectorXd& vantage = points[order[begin]];
+    size_t middle = begin + 1 + (end - begin - 1)/2;
+    std::nth_element(order.begin() + begin + 1,order.begin() + middle,order.begin() + end,
+                     [&](size_t a, size_t b){return (points[a] - vantage).squaredNorm() < (points[b] - vantage).squaredNorm();});
+    nodes[node].radius = (points[order[middle]] - vantage).norm();
+    int inside = build(begin + 1,middle);
+    int outside = build(middle,end);
+    nodes[node].inside = inside;
+    nodes[node].outside = outside;
+    return node;
+}
+
+void NoveltyIndex::push(std::vector<double> &heap, size_t k, double distance){
+    if(heap.size() < k){
+        heap.push_back(distance);
+        std::push_heap(heap.begin(),heap.end());
+    }
+    else if(distance < heap.front()){
+        std::pop_heap(heap.begin(),heap.end());
+        heap.back() = distance;
+        std::push_heap(heap.begin(),heap.end());
+    }
+}
+
+void NoveltyIndex::search(int node, const Eigen::Ref<const Eigen::VectorXd> &query, size_t k, std::vector<double> &heap) const{
+    const Node& n = nodes[node];
+    if(n.inside < 0){
+        for(size_t i = n.begin; i < n.end; i++)
+            if(alive[order[i]])
+                push(heap,k,(points[order[i]] - query).norm());
+        return;
+    }
+
+    double distance = (points[order[n.begin]] - query).norm();
+    if(alive[order[n.begin]])
+        push(heap,k,distance);
+    // in approximate mode, neighbours less than 1 + epsilon times closer than the k-th one are not searched for
+    auto tau = [&]() -> double {
+        if(heap.size() < k)
+            return std::numeric_limits<double>::infinity();
+        return mode == APPROXIMATE ? heap.front()/(1 + epsilon) : heap.front();
+    };
+    if(distance < n.radius){
+        search(n.inside,query,k,heap);
+        if(distance + tau() >= n.radius)
+            search(n.outside,query,k,heap);
+    }else{
+        search(n.outside,query,k,heap);
+        if(distance - tau() <= n.radius)
+            search(n.inside,query,k,heap);
+    }
+}
+
+void NoveltyIndex::nearest_distances(const Eigen::Ref<const Eigen::VectorXd> &query, size_t k, std::vector<double> &distances) const{
+    distances.clear();
+    if(k == 0)
+        return;
+    if(mode == BRUTE_FORCE){
+        block.squared_distances(query,distances);
+        size_t nbr_neighbours = std::min(k,distances.size());
+        std::partial_sort(distances.begin(),distances.begin() + nbr_neighbours,distances.end());
+        distances.resize(nbr_neighbours);
+        for(double &distance : distances)
+            distance = std::sqrt(distance);
+        return;
+    }
+    distances.reserve(k);
+    if(!nodes.empty())
+        search(0,query,k,distances);
+    for(size_t i = nbr_indexed; i < order.size(); i++)
+        if(alive[order[i]])
+            push(distances,k,(points[order[i]] - query).norm());
+    std::sort_heap(distances.begin(),distances.end());
+}
+
+double NoveltyIndex::sparseness(const Eigen::Ref<const Eigen::VectorXd> &desc, const Eigen::Ref<const Eigen::MatrixXd> &pop, int k) const{
+    if(k <= 0)
+        return 0;
+    std::vector<double> distances;
+    nearest_distances(desc,k,distances);
+    for(Eigen::Index i = 0; i < pop.cols(); i++)
+        distances.push_back((pop.col(i) - desc).norm());
+    if(distances.empty())
+        return 0;
+
+    size_t nbr_neighbours = std::min(static_cast<size_t>(k),distances.size());
+    std::nth_element(distances.begin(),distances.begin() + (nbr_neighbours - 1),distances.end());
+    double sum = 0;
+    for(size_t i = 0; i < nbr_neighbours; i++)
+        sum += distances[i];
+    return sum/nbr_neighbours;
+}
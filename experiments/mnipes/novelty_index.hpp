@@ -0,0 +1,85 @@
+#ifndef NOVELTY_INDEX_HPP
+#define NOVELTY_INDEX_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+#include "distance_kernels.hpp"
+
+namespace are {
+
+/**
+ * @brief Vantage point tree over behavioural descriptors for the k nearest neighbour queries of the novelty.
+ * The points inserted since the last build are scanned linearly, the tree is rebuilt once they are a quarter of
+ * the indexed ones, so an insertion costs O(log n) amortised. A replaced point stays in the tree as a dead vantage
+ * point until the next build. The approximate mode prunes the branches that cannot hold a neighbour closer than the
+ * current k-th distance divided by 1 + epsilon. The brute force mode scans a copy of the points stored as
+ * structure of arrays with squared_distances, which beats the tree on descriptors of many dimensions.
+ */
+class NoveltyIndex
+{
+public:
+    typedef enum Mode{
+        BRUTE_FORCE = 0,
+        EXACT = 1,
+        APPROXIMATE = 2
+    }Mode;
+
+    NoveltyIndex(Mode mode = EXACT, double epsilon = 0.1) : mode(mode), epsilon(epsilon){}
+
+    /// Mode named "brute_force", "exact" or "approximate", false if the name is unknown.
+    bool set_mode(const std::string& name, double epsilon);
+    Mode get_mode() const {return mode;}
+
+    void insert(const Eigen::VectorXd& point);
+    /// Replace the point inserted in position slot, as an archive evicting its descriptor in this slot.
+    void replace(size_t slot, const Eigen::VectorXd& point);
+    /// Index these points instead, to follow an archive that changed by other means than insert() and replace().
+    void rebuild(const std::vector<Eigen::VectorXd>& new_points);
+    size_t size() const {return slots.size();}
+
+    /// The min(k,size()) smallest distances from query to the indexed points, in increasing order.
+    void nearest_distances(const Eigen::Ref<const Eigen::VectorXd>& query, size_t k, std::vector<double>& distances) const;
+
+    /// Mean distance of desc to its k nearest neighbours among the indexed points and the columns of pop, as
+    /// Novelty::sparseness does on Novelty::distances(desc,archive,pop) when the indexed points are the archive.
+    double sparseness(const Eigen::Ref<const Eigen::VectorXd>& desc, const Eigen::Ref<const Eigen::MatrixXd>& pop, int k) const;
+
+private:
+    static const size_t LEAF_SIZE = 8;
+
+    typedef struct Node{
+        // leaves hold the points order[begin,end), inner nodes split them at radius from order[begin]
+        size_t begin;
+        size_t end;
+        double radius;
+        int inside;
+        int outside;
+    }Node;
+
+    void build();
+    int build(size_t begin, size_t end);
+    bool needs_build() const;
+    void search(int node, const Eigen::Ref<const Eigen::VectorXd>& query, size_t k, std::vector<double>& heap) const;
+    static void push(std::vector<double>& heap, size_t k, double distance);
+
+    Mode mode;
+    double epsilon;
+    std::vector<Eigen::VectorXd> points;
+    // replaced points are kept until the next build, alive is false for them
+    std::vector<bool> alive;
+    size_t nbr_dead = 0;
+    // the point of each slot, in the order of the archive
+    std::vector<size_t> slots;
+    // the points order[0,nbr_indexed) are in the tree, the others are scanned
+    size_t nbr_indexed = 0;
+    std::vector<size_t> order;
+    std::vector<Node> nodes;
+    // the points by slot, in brute force mode
+    DescriptorBlock block;
+};
+
+}
+
+#endif //NOVELTY_INDEX_HPP
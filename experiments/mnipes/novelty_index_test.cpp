@@ -0,0 +1,81 @@
+#include "novelty_index.hpp"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+// the k smallest distances from query to points, as the index should give them
+inline std::vector<double> brute_force(const std::vector<Eigen::VectorXd>& points, const Eigen::VectorXd& query, size_t k){
+    std::vector<double> distances;
+    for(const Eigen::VectorXd& p : points)
+        distances.push_back((p - query).norm());
+    std::sort(distances.begin(),distances.end());
+    distances.resize(std::min(k,distances.size()));
+    return distances;
+}
+
+inline int count_errors(const std::vector<double>& distances, const std::vector<double>& expected){
+    if(distances.size() != expected.size())
+        return 1;
+    int errors = 0;
+    for(size_t i = 0; i < distances.size(); i++)
+        if(std::abs(distances[i] - expected[i]) > 1e-9)
+            errors++;
+    return errors;
+}
+
+inline Eigen::VectorXd random_point(std::mt19937& gen, int dim, bool binary){
+    std::uniform_real_distribution<double> unif(0,1);
+    Eigen::VectorXd p(dim);
+    for(int d = 0; d < dim; d++)
+        p(d) = binary ? (unif(gen) < 0.3) : unif(gen);
+    return p;
+}
+
+int main()
+{
+    std::mt19937 gen(1);
+    int nbr_errors = 0;
+
+    // 3 dimensions as the final positions, 64 binary ones as the visited zones
+    for(int dim : {3,64}){
+        for(const char* mode : {"brute_force","exact","approximate"}){
+            are::NoveltyIndex index;
+            index.set_mode(mode,0.);
+            std::vector<Eigen::VectorXd> points;
+            int errors = 0;
+            for(int i = 0; i < 2000; i++){
+                Eigen::VectorXd p = random_point(gen,dim,dim == 64);
+                // every third point takes the slot of an earlier one, as an archive evicting it
+                if(i % 3 == 2){
+                    size_t slot = gen() % points.size();
+                    points[slot] = p;
+                    index.replace(slot,p);
+                }else{
+                    points.push_back(p);
+                    index.insert(p);
+                }
+                if(index.size() != points.size())
+                    errors++;
+
+                Eigen::VectorXd query = random_point(gen,dim,dim == 64);
+                std::vector<double> distances;
+                index.nearest_distances(query,15,distances);
+                errors += count_errors(distances,brute_force(points,query,15));
+            }
+
+            // an index rebuilt from the points answers as the one that followed them
+            are::NoveltyIndex rebuilt;
+            rebuilt.set_mode(mode,0.);
+            rebuilt.rebuild(points);
+            Eigen::VectorXd query = random_point(gen,dim,dim == 64);
+            std::vector<double> distances;
+            rebuilt.nearest_distances(query,15,distances);
+            errors += count_errors(distances,brute_force(points,query,15));
+
+            std::cout << "dim " << dim << " " << mode << " : " << errors << " errors" << std::endl;
+            nbr_errors += errors;
+        }
+    }
+
+    return nbr_errors == 0 ? 0 : 1;
+}
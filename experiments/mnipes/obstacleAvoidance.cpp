@@ -1,6 +1,7 @@
 #include "obstacleAvoidance.hpp"
 
 #include <boost/algorithm/string.hpp>
+#include "tools.hpp"
 
 using namespace are::sim;
 
@@ -15,6 +16,7 @@ ObstacleAvoidance::ObstacleAvoidance(const settings::ParametersMapPtr& params)
     settings::defaults::parameters->emplace("#arenaSize",new settings::Double(2.));
     settings::defaults::parameters->emplace("#nbrWaypoints",new settings::Integer(2));
     settings::defaults::parameters->emplace("#flatFloor",new settings::Boolean(true));
+    settings::defaults::parameters->emplace("#gridResolution",new settings::Integer(8));
 }
 
 void ObstacleAvoidance::init(){
@@ -34,60 +36,50 @@ void ObstacleAvoidance::init(){
         }
     }
 
+    eval_time = settings::getParameter<settings::Float>(parameters,"#maxEvalTime").value;
+    nbr_waypoints = settings::getParameter<settings::Integer>(parameters,"#nbrWaypoints").value;
+
+    // one waypoint per interval, plus the ones of the ticks between the end of the evaluation time and the stop
     trajectory.clear();
+    trajectory.reserve(nbr_waypoints + 5);
+    trajectory_hash = FNV_OFFSET_BASIS;
 
-    grid_zone = Eigen::MatrixXi::Zero(8,8);
+    int grid_resolution = settings::getParameter<settings::Integer>(parameters,"#gridResolution").value;
+    double arena_size = settings::getParameter<settings::Double>(parameters,"#arenaSize").value;
+    grid_zone.reset(grid_resolution,arena_size);
     number_of_collisions = 0;
 
-    std::vector<int> th;
-    build_tiled_floor(th);
+    // Only the dynamic state is reset while the scene stays loaded
+    if(reset_tiled_floor(tiles_handles))
+        collision_checker.reset_robot();
+    else{
+        tiles_handles.clear();
+        build_tiled_floor(tiles_handles);
+
+        std::vector<std::string> obstacle_names;
+        for(int i = 0; i < NBR_OBSTACLES; i++)
+            obstacle_names.push_back("Obstacle_" + std::to_string(i));
+        collision_checker.set_obstacles(obstacle_names);
+    }
 
 
 }
 
 std::vector<double> ObstacleAvoidance::fitnessFunction(const Individual::Ptr &ind){
    // if(number_of_collisions == 0)
-        return {static_cast<double>(grid_zone.sum())/64.f};
+        return {current_fitness()};
     //return {(static_cast<double>(grid_zone.sum())/static_cast<double>(number_of_collisions))/64.f};
 }
 
-std::pair<int,int> ObstacleAvoidance::real_coordinate_to_matrix_index(const std::vector<double> &pos){
-    std::pair<int,int> indexes;
-
-    indexes.first = std::trunc(pos[0]/0.25 + 4);
-    indexes.second = std::trunc(pos[1]/0.25 + 4);
-    if(indexes.first == 8)
-        indexes.first = 7;
-    if(indexes.second == 8)
-        indexes.second = 7;
-    return indexes;
-}
-
-
 float ObstacleAvoidance::updateEnv(float simulationTime, const Morphology::Ptr &morph){
-    float evalTime = settings::getParameter<settings::Float>(parameters,"#maxEvalTime").value;
-    int nbr_wp = settings::getParameter<settings::Integer>(parameters,"#nbrWaypoints").value;
     int morphHandle = morph->getMainHandle();
 
     waypoint wp;
     simGetObjectPosition(morphHandle, -1, wp.position);
     simGetObjectOrientation(morphHandle,-1,wp.orientation);
 
-    int obst_handle;
-    int coll;
-    for(int i = 0; i < 11; i++){
-        std::stringstream sstr;
-        sstr << "Obstacle_" << i;
-        obst_handle = simGetObjectHandle(sstr.str().c_str());
-        int nbr_handles;
-        int* handles = simGetObjectsInTree(morphHandle,sim_handle_all,0,&nbr_handles);
-        coll = simCheckCollision(morphHandle,obst_handle);
-        assert(coll >= 0);
-        for(int j = 0; j < nbr_handles; j++)
-            coll += simCheckCollision(handles[j],obst_handle);
-        if(coll > 0 && number_of_collisions < 64)
-            number_of_collisions+=1;
-    }
+    int coll = collision_checker.count_colliding_obstacles(morphHandle);
+    number_of_collisions = std::min(64,number_of_collisions + coll);
 //    std::cout << wp.to_string() << std::endl;
 
     if(wp.is_nan())
@@ -102,41 +94,80 @@ float ObstacleAvoidance::updateEnv(float simulationTime, const Morphology::Ptr &
     final_position[1] = static_cast<double>(wp.position[1]);
     final_position[2] = static_cast<double>(wp.position[2]);
 
-    std::pair<int,int> indexes = real_coordinate_to_matrix_index(final_position);
-    grid_zone(indexes.first,indexes.second) = 1;
+    grid_zone.visit(final_position[0],final_position[1]);
 
-    float interval = evalTime/static_cast<float>(nbr_wp);
+    float interval = eval_time/static_cast<float>(nbr_waypoints);
     if(simulationTime >= interval*trajectory.size())
-        trajectory.push_back(wp);
-    else if(simulationTime >= evalTime)
-        trajectory.push_back(wp);
+        append_waypoint(wp);
+    else if(simulationTime >= eval_time)
+        append_waypoint(wp);
 
     return 0;
 }
 
-void ObstacleAvoidance::build_tiled_floor(std::vector<int> &tiles_handles){
-    bool flatFloor = settings::getParameter<settings::Boolean>(parameters,"#flatFloor").value;
+void ObstacleAvoidance::append_waypoint(const are::waypoint &wp){
+    trajectory.push_back(wp);
+    trajectory_hash = hash_waypoint(wp,trajectory_hash);
+}
+
+uint64_t ObstacleAvoidance::hash_waypoint(const are::waypoint &wp, uint64_t hash){
+    hash = fnv1a_hash(wp.position,sizeof(wp.position),hash);
+    return fnv1a_hash(wp.orientation,sizeof(wp.orientation),hash);
+}
+
+std::vector<are::waypoint> ObstacleAvoidance::release_trajectory(){
+    std::vector<waypoint> released;
+    released.swap(trajectory);
+    return released;
+}
 
+void ObstacleAvoidance::build_tiled_floor(std::vector<int> &tiles_handles){
     float tile_size[3] = {0.249f,0.249f,0.01f};
-    float tile_increment = 0.25;
-    float starting_pos[3] = {-0.875f,-0.875f,0.005f};
     for(int i = 0; i < 8; i++){
         for(int j = 0; j < 8; j++){
             tiles_handles.push_back(simCreatePureShape(0,8,tile_size,0.05f,nullptr));
             std::stringstream name;
             name << "tile_" << i << j;
             simSetObjectName(tiles_handles.back(),name.str().c_str());
+            simSetEngineFloatParameter(sim_bullet_body_friction,tiles_handles.back(),nullptr,1000);//randNum->randFloat(0,1000));
+            simSetObjectSpecialProperty(tiles_handles.back(),sim_objectspecialproperty_detectable_ultrasonic);
+            simSetModelProperty(tiles_handles.back(), sim_modelproperty_not_dynamic);
+        }
+    }
+    place_tiles(tiles_handles);
+}
+
+bool ObstacleAvoidance::reset_tiled_floor(const std::vector<int> &handles){
+    if(handles.size() != 64)
+        return false;
+    // the scene may have been reloaded, and the handles given to other objects
+    for(int handle : handles)
+        if(simIsHandleValid(handle,sim_appobj_object_type) != 1)
+            return false;
+    if(simGetObjectHandle("tile_00") != handles.front() || simGetObjectHandle("tile_77") != handles.back())
+        return false;
+    place_tiles(handles);
+    return true;
+}
+
+void ObstacleAvoidance::place_tiles(const std::vector<int> &handles){
+    bool flatFloor = settings::getParameter<settings::Boolean>(parameters,"#flatFloor").value;
+    float tile_increment = 0.25;
+    float starting_pos[3] = {-0.875f,-0.875f,0.005f};
+    for(int i = 0; i < 8; i++){
+        for(int j = 0; j < 8; j++){
             float height = -0.004;
             if(!flatFloor){
                 height = randNum->randFloat(-0.005,-0.001);
             }
             float pos[3] = {starting_pos[0] + i*tile_increment,starting_pos[1] + j*tile_increment,height};
-            simSetObjectPosition(tiles_handles.back(),-1,pos);
-            simSetEngineFloatParameter(sim_bullet_body_friction,tiles_handles.back(),nullptr,1000);//randNum->randFloat(0,1000));
-            simSetObjectSpecialProperty(tiles_handles.back(),sim_objectspecialproperty_detectable_ultrasonic);
-            simSetModelProperty(tiles_handles.back(), sim_modelproperty_not_dynamic);
+            simSetObjectPosition(handles[i*8 + j],-1,pos);
         }
     }
 }
 
-
+void ObstacleAvoidance::save_state(ObstacleAvoidanceState &state) const{
+    state.grid_zone = grid_zone;
+    state.trajectory = trajectory;
+    state.final_position = final_position;
+}
@@ -7,17 +7,39 @@
 #include "v_repLib.h"
 #elif defined (COPPELIASIM)
 #include "simLib.h"
+#elif defined (STANDIN_SIM)
+#include "standin_sim.h"
 #endif
 
 #include "simulatedER/VirtualEnvironment.hpp"
 #include "ARE/Individual.h"
 #include "simulatedER/Morphology.h"
+#include "collision_checker.hpp"
+#include "visited_grid.hpp"
+#include "incremental_fitness.hpp"
 
 namespace are {
 
 namespace sim{
 
-class ObstacleAvoidance : public VirtualEnvironment
+/**
+ * @brief Behaviour of an ObstacleAvoidance evaluation so far, what its descriptors are computed from.
+ */
+typedef struct ObstacleAvoidanceState{
+    VisitedGrid grid_zone;
+    std::vector<waypoint> trajectory;
+    std::vector<double> final_position;
+
+    template<class archive>
+    void serialize(archive &arch, const unsigned int v)
+    {
+        arch & grid_zone;
+        arch & trajectory;
+        arch & final_position;
+    }
+}ObstacleAvoidanceState;
+
+class ObstacleAvoidance : public VirtualEnvironment, public IncrementalFitness
 {
 public:
 
@@ -30,23 +52,44 @@ public:
     void init() override;
 
     std::vector<double> fitnessFunction(const Individual::Ptr &ind) override;
+    /// Coverage of the grid, the visited cells are counted as they are visited.
+    double current_fitness() const override {return grid_zone.coverage();}
     float updateEnv(float simulationTime, const Morphology::Ptr &morph) override;
 
     ///time point to check the status of the robot
     float timeCheck = 0.0;
 
     const std::vector<waypoint> &get_trajectory(){return trajectory;}
+    /// Hash of the waypoints of the trajectory, updated as they are appended.
+    uint64_t get_trajectory_hash() const {return trajectory_hash;}
+    /// Hand the trajectory over, the environment is left with an empty one until the next init().
+    std::vector<waypoint> release_trajectory();
+    static uint64_t hash_waypoint(const waypoint &wp, uint64_t hash);
 
     void build_tiled_floor(std::vector<int> &tiles_handles);
+    /// Put the tiles built by a previous evaluation back in place, return false if they are not in the scene anymore.
+    bool reset_tiled_floor(const std::vector<int> &handles);
 
-    std::pair<int,int> real_coordinate_to_matrix_index(const std::vector<double> &pos);
+    const VisitedGrid &get_visited_zones(){return grid_zone;}
 
-    const Eigen::MatrixXi &get_visited_zone_matrix(){return grid_zone;}
+    void save_state(ObstacleAvoidanceState &state) const;
 
 private:
+    static const int NBR_OBSTACLES = 11;
+
+    void append_waypoint(const waypoint &wp);
+    /// Heights are drawn again for each evaluation if the floor is not flat.
+    void place_tiles(const std::vector<int> &handles);
+
+    float eval_time;
+    int nbr_waypoints;
+    CollisionChecker collision_checker;
+    // the static scene is built once per simulator instance
+    std::vector<int> tiles_handles;
+    uint64_t trajectory_hash;
     int move_counter = 0;
     int number_of_collisions = 0;
-    Eigen::MatrixXi grid_zone;
+    VisitedGrid grid_zone;
 };
 
 } //sim
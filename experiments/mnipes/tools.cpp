@@ -172,6 +172,29 @@ double average(std::vector<double> v)
 
 }
 
+double kendall_tau(const std::vector<double> &x, const std::vector<double> &y)
+{
+    long int concordant_minus_discordant = 0;
+    long int pairs_not_tied_x = 0;
+    long int pairs_not_tied_y = 0;
+    for (size_t i = 0; i < x.size(); i++)
+    {
+        for (size_t j = i + 1; j < x.size(); j++)
+        {
+            int sign_x = (x[i] > x[j]) - (x[i] < x[j]);
+            int sign_y = (y[i] > y[j]) - (y[i] < y[j]);
+            concordant_minus_discordant += sign_x * sign_y;
+            pairs_not_tied_x += sign_x != 0;
+            pairs_not_tied_y += sign_y != 0;
+        }
+    }
+    if (pairs_not_tied_x == 0 || pairs_not_tied_y == 0)
+    {
+        return 0.0;
+    }
+    return (double) concordant_minus_discordant / sqrt((double) pairs_not_tied_x * (double) pairs_not_tied_y);
+}
+
 
 std::string hash_string(const std::string &str)
 {
@@ -1,7 +1,9 @@
 #ifndef tools_HPP
 #define tools_HPP
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -22,6 +24,37 @@ private:
     std::chrono::_V2::system_clock::time_point tt_tic;
 };
 
+/**
+ * @brief Gates a callback run at every physics timestep to a coarser period of simulated time.
+ * A simulation time going backward means a new evaluation has started.
+ */
+class PeriodicClock
+{
+public:
+    void set_period(double period, double time_step){
+        this->period = std::max(period,time_step);
+        this->time_step = time_step;
+    }
+    bool is_set() const {return time_step > 0;}
+
+    /// True at the first call of an evaluation, then once the period has elapsed since the last true.
+    bool due(double sim_time){
+        if(sim_time < last_time)
+            next_time = 0;
+        last_time = sim_time;
+        // half a timestep of tolerance against the rounding of the simulation time
+        if(sim_time + time_step/2 < next_time)
+            return false;
+        next_time = std::max(next_time + period, sim_time + time_step/2);
+        return true;
+    }
+
+private:
+    double period = 0;
+    double time_step = 0;
+    double next_time = 0;
+    double last_time = 0;
+};
 
 double get_adjusted_runtime(double progress, double constantmodifyMaxEvalTime, double max_runtime);
 
@@ -77,7 +110,24 @@ bool are_doubles_equal(double x1, double x2);
 
 double average(std::vector<double> v);
 
+// Kendall rank correlation (tau-b, accounts for ties) between two equally long samples.
+double kendall_tau(const std::vector<double> &x, const std::vector<double> &y);
+
 std::string hash_string(const std::string &str);
 
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+
+// 64 bit FNV-1a, pass the previous hash to continue hashing a stream.
+inline uint64_t fnv1a_hash(const void *data, size_t size, uint64_t hash = FNV_OFFSET_BASIS)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "visited_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "distance_kernels.hpp"
+
+using namespace are;
+
+void VisitedGrid::reset(int resolution, double arena_size){
+    this->resolution = resolution;
+    cell_size = arena_size/resolution;
+    words.assign((nbr_cells() + WORD_BITS - 1)/WORD_BITS,0);
+    nbr_visited = 0;
+}
+
+Eigen::VectorXd VisitedGrid::to_vector() const{
+    Eigen::VectorXd desc(nbr_cells());
+    for(int j = 0; j < resolution; j++)
+        for(int i = 0; i < resolution; i++)
+            desc(i + j*resolution) = is_visited(i,j) ? 1. : 0.;
+    return desc;
+}
+
+int VisitedGrid::hamming_distance(const VisitedGrid &a, const VisitedGrid &b){
+    int dist = 0;
+    for(size_t w = 0; w < a.words.size(); w++)
+        dist += __builtin_popcountll(a.words[w] ^ b.words[w]);
+    return dist;
+}
+
+void GridBlock::push_back(const VisitedGrid &grid){
+    if(nbr == 0)
+        nbr_words = grid.get_words().size();
+    words.insert(words.end(),grid.get_words().begin(),grid.get_words().end());
+    nbr++;
+}
+
+void GridBlock::set(size_t i, const VisitedGrid &grid){
+    std::copy(grid.get_words().begin(),grid.get_words().end(),words.begin() + i*nbr_words);
+}
+
+void GridBlock::distances(const VisitedGrid &grid, std::vector<double> &out) const{
+    std::vector<uint32_t> hamming(nbr);
+    if(nbr > 0)
+        hamming_distances(grid.get_words().data(),words.data(),nbr_words,nbr,hamming.data());
+    for(uint32_t dist : hamming)
+        out.push_back(std::sqrt(static_cast<double>(dist)));
+}
+
+double are::grid_sparseness(const VisitedGrid &grid, const GridBlock &archive, const GridBlock &pop, int k){
+    std::vector<double> distances;
+    distances.reserve(archive.size() + pop.size());
+    archive.distances(grid,distances);
+    pop.distances(grid,distances);
+    if(distances.empty() || k <= 0)
+        return 0;
+
+    size_t nbr_neighbours = std::min(static_cast<size_t>(k),distances.size());
+    std::nth_element(distances.begin(),distances.begin() + (nbr_neighbours - 1),distances.end());
+    double sum = 0;
+    for(size_t i = 0; i < nbr_neighbours; i++)
+        sum += distances[i];
+    return sum/nbr_neighbours;
+}
@@ -0,0 +1,106 @@
+#ifndef VISITED_GRID_HPP
+#define VISITED_GRID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <Eigen/Core>
+#include <boost/serialization/vector.hpp>
+
+namespace are {
+
+/**
+ * @brief Occupancy grid of the cells of the arena visited by a robot, packed in 64 bit words.
+ * Cell (i,j) covers x in [(i - resolution/2)*cell_size, (i + 1 - resolution/2)*cell_size), likewise for y,
+ * positions outside of the arena count in the border cells.
+ */
+class VisitedGrid
+{
+public:
+    VisitedGrid(){}
+    VisitedGrid(int resolution, double arena_size){reset(resolution,arena_size);}
+
+    void reset(int resolution, double arena_size);
+    void clear(){std::fill(words.begin(),words.end(),0); nbr_visited = 0;}
+
+    void visit(double x, double y){
+        int bit = cell_index(x) + cell_index(y)*resolution;
+        uint64_t mask = uint64_t(1) << (bit%WORD_BITS);
+        uint64_t &word = words[bit/WORD_BITS];
+        nbr_visited += (word & mask) == 0;
+        word |= mask;
+    }
+    bool is_visited(int i, int j) const{
+        int bit = i + j*resolution;
+        return (words[bit/WORD_BITS] >> (bit%WORD_BITS)) & 1;
+    }
+
+    /// Number of visited cells, counted as they are visited.
+    int count() const {return nbr_visited;}
+    int nbr_cells() const {return resolution*resolution;}
+    int get_resolution() const {return resolution;}
+    /// Proportion of the cells visited.
+    double coverage() const {return static_cast<double>(count())/nbr_cells();}
+
+    /// 0/1 vector of the cells, x index first.
+    Eigen::VectorXd to_vector() const;
+
+    /// Number of cells visited by one grid only. Both grids must have the same resolution.
+    static int hamming_distance(const VisitedGrid& a, const VisitedGrid& b);
+    const std::vector<uint64_t>& get_words() const {return words;}
+
+    template<class archive>
+    void serialize(archive &arch, const unsigned int v)
+    {
+        arch & resolution;
+        arch & cell_size;
+        arch & words;
+        arch & nbr_visited;
+    }
+
+private:
+    static const int WORD_BITS = 64;
+
+    int cell_index(double coord) const{
+        int index = static_cast<int>(std::trunc(coord/cell_size + resolution/2.));
+        return index < 0 ? 0 : (index >= resolution ? resolution - 1 : index);
+    }
+
+    int resolution = 0;
+    double cell_size = 1;
+    std::vector<uint64_t> words;
+    int nbr_visited = 0;
+};
+
+/**
+ * @brief Words of grids of the same resolution stored one after another, for the distances of a grid to all of them.
+ * Grids are appended or replaced by position, as the slots of a novelty archive.
+ */
+class GridBlock
+{
+public:
+    void push_back(const VisitedGrid& grid);
+    void set(size_t i, const VisitedGrid& grid);
+    void clear(){words.clear(); nbr = 0;}
+    size_t size() const {return nbr;}
+
+    /// Appends the square roots of the Hamming distances from grid to the grids of the block.
+    void distances(const VisitedGrid& grid, std::vector<double>& out) const;
+
+private:
+    size_t nbr_words = 0;
+    size_t nbr = 0;
+    std::vector<uint64_t> words;
+};
+
+/**
+ * @brief Novelty of a grid: mean distance to its k nearest neighbours in the archive and the population.
+ * The distance is the square root of the Hamming distance, which is the euclidean distance between the
+ * 0/1 descriptors given by to_vector().
+ */
+double grid_sparseness(const VisitedGrid& grid, const GridBlock& archive, const GridBlock& pop, int k);
+
+}
+
+#endif //VISITED_GRID_HPP
@@ -0,0 +1,50 @@
+#include "window_halving_policy.hpp"
+
+#include <algorithm>
+
+using namespace are;
+
+REGISTER_EARLY_STOPPING_POLICY("window_halving", WindowHalvingPolicy)
+
+void WindowHalvingPolicy::init(const settings::ParametersMapPtr& param, int pop_size)
+{
+    HalvingPolicy::init(param, pop_size);
+    eta = settings::getParameter<settings::Double>(parameters,"#halvingReductionFactor").value;
+    int window = settings::getParameter<settings::Integer>(parameters,"#halvingWindow").value;
+    window_size = window > 0 ? window : pop_size;
+
+    float max_eval_time = settings::getParameter<settings::Float>(parameters,"#maxEvalTime").value;
+    set_time_checkpoints(max_eval_time, pop_size, eta);
+
+    rung_results.assign(n_of_halvings, std::deque<double>());
+    update_fitness_checkpoints = false;
+}
+
+void WindowHalvingPolicy::on_eval_end(const EvalContext& ctx, double fitness, double& best_fitness)
+{
+    for (int i = 0; i < n_of_halvings; i++)
+    {
+        // rungs are reached in increasing order
+        if (ctx.consumed_runtime < time_checkpoints[i] - time_delta / 2)
+            break;
+        rung_results[i].push_back(ctx.observed_fitnesses[i]);
+        if (rung_results[i].size() > window_size)
+            rung_results[i].pop_front();
+        update_rung_threshold(i);
+    }
+}
+
+void WindowHalvingPolicy::update_rung_threshold(int rung)
+{
+    const std::deque<double>& results = rung_results[rung];
+    // nothing is stopped at a rung before eta results are known
+    if (results.size() < eta)
+    {
+        fitness_checkpoints[rung] = -1e20;
+        return;
+    }
+    sorted_results.assign(results.begin(), results.end());
+    size_t position = (size_t)((1.0 - 1.0 / eta) * (double)(sorted_results.size() - 1));
+    std::nth_element(sorted_results.begin(), sorted_results.begin() + position, sorted_results.end());
+    fitness_checkpoints[rung] = sorted_results[position];
+}
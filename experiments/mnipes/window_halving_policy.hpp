@@ -0,0 +1,38 @@
+#ifndef WINDOW_HALVING_POLICY_HPP
+#define WINDOW_HALVING_POLICY_HPP
+
+#include <deque>
+
+#include "early_stopping.hpp"
+
+namespace are{
+
+/**
+ * @brief Successive halving with thresholds over a sliding window of results. The rungs are the time_checkpoints of
+ * the halving policy, spaced by a factor #halvingReductionFactor (eta). Each finished evaluation adds the fitnesses it
+ * reached at each rung to a window of the last #halvingWindow results, and an evaluation is stopped at rung i if its
+ * fitness is not in the top 1/eta of the window at this rung. Thresholds are updated after every evaluation instead of
+ * every UPDATE_F_CHECKPOINTS_EVERY_N_GENS generations. The generations stay synchronous and a stopped evaluation is
+ * never promoted, unlike ASHA.
+ */
+class WindowHalvingPolicy : public HalvingPolicy
+{
+public:
+    void init(const settings::ParametersMapPtr& param, int pop_size) override;
+    void on_eval_end(const EvalContext& ctx, double fitness, double& best_fitness) override;
+    void on_epoch(const std::vector<EvalResult>& results, int generation, double& best_fitness) override{}
+    bool updates_per_evaluation() const override {return true;}
+
+private:
+    void update_rung_threshold(int rung);
+
+    double eta;
+    size_t window_size;
+    // The last window_size fitnesses observed at each rung, including the ones of the evaluations stopped at this rung.
+    std::vector<std::deque<double>> rung_results;
+    std::vector<double> sorted_results;
+};
+
+}
+
+#endif //WINDOW_HALVING_POLICY_HPP
@@ -9,6 +9,7 @@
 #include <math.h>
 #include <fstream>
 #include <iostream>
+#include <tbb/parallel_for.h>
 
 const char *build_str = "NIPES.cpp compilation time: " VERSION " " __DATE__ " " __TIME__;
 
@@ -16,19 +17,42 @@ const char *build_str = "NIPES.cpp compilation time: " VERSION " " __DATE__ " "
 using namespace are;
 
 Eigen::VectorXd NIPESIndividual::descriptor()
+{
+    return get_descriptor();
+}
+
+void NIPESIndividual::cache_descriptor()
 {
     if(descriptor_type == FINAL_POSITION){
         double arena_size = settings::getParameter<settings::Double>(parameters,"#arenaSize").value;
-        Eigen::VectorXd desc(3);
-        desc << (final_position[0]+arena_size/2.)/arena_size, (final_position[1]+arena_size/2.)/arena_size, (final_position[2]+arena_size/2.)/arena_size;
-        return desc;
+        cached_descriptor.resize(3);
+        for(int i = 0; i < 3; i++)
+            cached_descriptor(i) = (final_position[i]+arena_size/2.)/arena_size;
     }else if(descriptor_type == VISITED_ZONES){
-        Eigen::MatrixXd vz = visited_zones.cast<double>();
-        Eigen::VectorXd desc(Eigen::Map<Eigen::VectorXd>(vz.data(),vz.cols()*vz.rows()));
-        return desc;
+        cached_descriptor = visited_zones.to_vector();
     }
 }
 
+const Eigen::VectorXd& NIPESIndividual::get_descriptor()
+{
+    if(cached_descriptor.size() == 0)
+        cache_descriptor();
+    return cached_descriptor;
+}
+
+void NIPESIndividual::update(double delta_time)
+{
+    if(!control_clock.is_set())
+        control_clock.set_period(control_period(parameters), settings::getParameter<settings::Float>(parameters,"#timeStep").value);
+    // the sensors and the controller run every #controlPeriod, the commands are held in between
+    if(control_clock.due(delta_time))
+        morphology->command(control->update(morphology->update()));
+    energy_cost += static_cast<sim::Morphology*>(morphology.get())->get_energy_cost();
+    if(std::isnan(energy_cost))
+        energy_cost = 0;
+    sim_time = delta_time;
+}
+
 std::string NIPESIndividual::to_string()
 {
     std::stringstream sstream;
@@ -56,36 +80,47 @@ void NIPESIndividual::from_string(const std::string &str){
     morphGenome->set_randNum(randNum);
 }
 
-double NIPES::get_currentMaxEvalTime()
+double NIPESIndividual::fitness_at_runtime(double runtime, double time_delta)
 {
-    if (population.size() == 0)
-    {
-        // std::cout << "get_currentMaxEvalTime() -> population.size() == 0" << std::endl;
-        return 0.0;
-    }
-    
-    auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(population[0]);
-    return NIPESind->get_max_eval_time();
+    // the first tick is at time_delta
+    long int tick = std::max(0L, lround(runtime / time_delta) - 1);
+    double fitness = context.observed_curve.at_tick(tick);
+    return fitness == -__DBL_MAX__ ? getObjectives()[0] : fitness;
 }
 
-double NIPES::getFitness(const Environment::Ptr &env)
+void NIPESIndividual::set_generation_behaviour(sim::ObstacleAvoidanceState &&behaviour)
 {
-    Individual::Ptr ind = std::dynamic_pointer_cast<sim::NN2Individual>(population[currentIndIndex]);
-    std::vector<double> fitness = env->fitnessFunction(ind);
-    return fitness[0];
+    generation_behaviour = std::move(behaviour);
+    generation_energy_cost = energy_cost;
+    generation_behaviour_recorded = true;
 }
 
-void NIPES::set_currentMaxEvalTime(double new_currentMaxEvalTime)
+void NIPESIndividual::use_generation_behaviour()
 {
-    if (population.size() == 0)
-    {
+    if(!generation_behaviour_recorded)
         return;
-    }
+    final_position = generation_behaviour.final_position;
+    trajectory = generation_behaviour.trajectory;
+    if(descriptor_type == VISITED_ZONES)
+        visited_zones = generation_behaviour.grid_zone;
+    energy_cost = generation_energy_cost;
+    cache_descriptor();
+}
+
+double NIPES::get_currentMaxEvalTime()
+{
+    return current_max_eval_time;
+}
+
+void NIPES::set_currentMaxEvalTime(double new_currentMaxEvalTime)
+{
+    current_max_eval_time = new_currentMaxEvalTime;
 
     for (auto ind: population)
     {
         auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
         NIPESind->set_max_eval_time((float) new_currentMaxEvalTime);
+        NIPESind->set_generation_eval_time((float) new_currentMaxEvalTime);
     }
     // std::cout << "set_currentMaxEvalTime() -> " << get_currentMaxEvalTime() << std::endl;
 }
@@ -99,31 +134,62 @@ void NIPES::init(){
     subexperiment_name = settings::getParameter<settings::String>(parameters,"#subexperimentName").value;
     std::cout << build_str << std::endl;
 
-    if (
-        subexperiment_name != "measure_ranks" && 
-        subexperiment_name != "standard"      &&
-        subexperiment_name != "halving"       &&
-        subexperiment_name != "bestasref")
+    early_stopping = EarlyStoppingRegistry::create(subexperiment_name);
+    if (!early_stopping)
     {
         std::cerr << "ERROR: subexperimentName = " << subexperiment_name << " not recognized." << std::endl;
         exit(1);
     }
     
 
-     if (subexperiment_name == "measure_ranks" && settings::getParameter<settings::Boolean>(parameters,"#modifyMaxEvalTime").value == false)
-     {
-        std::cerr << "ERROR: subexperimentName = measure_ranks" << "requires modifyMaxEvalTime = true." << std::endl;
-        exit(1);
-     }
-
-
     settings::defaults::parameters->emplace("#modifyMaxEvalTime",new settings::Boolean(false));
+    EarlyStoppingRegistry::set_default_parameters();
+    settings::defaults::parameters->emplace("#maxSimulatedTime",new settings::Double(0.));
+    settings::defaults::parameters->emplace("#maxWallTime",new settings::Double(0.));
+    settings::defaults::parameters->emplace("#adaptiveMaxEvalTime",new settings::Boolean(false));
+    settings::defaults::parameters->emplace("#rankAgreementThreshold",new settings::Double(0.8));
+    settings::defaults::parameters->emplace("#rankAgreementSampleSize",new settings::Integer(8));
+    settings::defaults::parameters->emplace("#rankAgreementEveryNGens",new settings::Integer(10));
+    settings::defaults::parameters->emplace("#watchdogFactor",new settings::Double(0.));
+    settings::defaults::parameters->emplace("#watchdogMinTime",new settings::Double(60.));
+    settings::defaults::parameters->emplace("#noveltyIndex",new settings::String("exact"));
+    settings::defaults::parameters->emplace("#noveltyIndexEpsilon",new settings::Double(0.1));
+    settings::defaults::parameters->emplace("#archiveMaxSize",new settings::Integer(0));
+    settings::defaults::parameters->emplace("#archiveEviction",new settings::String("least_novel"));
+    settings::defaults::parameters->emplace("#archiveCellSize",new settings::Double(0.1));
     result_filename =  settings::getParameter<settings::String>(parameters,"#repository").value + 
                        std::string("/") + 
                        settings::getParameter<settings::String>(parameters,"#resultFile").value;
 
 
     static const bool modifyMaxEvalTime = settings::getParameter<settings::Boolean>(parameters,"#modifyMaxEvalTime").value;
+    modify_max_eval_time = modifyMaxEvalTime;
+    time_step = settings::getParameter<settings::Float>(parameters,"#timeStep").value;
+    time_delta = check_period(parameters);
+    // the server requeues the individual of a client that exits, a single instance would only lose the run
+    int instance_type = settings::getParameter<settings::Integer>(parameters,"#instanceType").value;
+    watchdog.set_limits(instance_type == 0 ? 0 : settings::getParameter<settings::Double>(parameters,"#watchdogFactor").value,
+                        settings::getParameter<settings::Double>(parameters,"#watchdogMinTime").value);
+    std::string novelty_index = settings::getParameter<settings::String>(parameters,"#noveltyIndex").value;
+    if (!archive_index.set_mode(novelty_index, settings::getParameter<settings::Double>(parameters,"#noveltyIndexEpsilon").value))
+    {
+        std::cerr << "ERROR: noveltyIndex = " << novelty_index << " not recognized." << std::endl;
+        exit(1);
+    }
+    std::string archive_eviction_name = settings::getParameter<settings::String>(parameters,"#archiveEviction").value;
+    if (!archive_eviction.set_policy(archive_eviction_name))
+    {
+        std::cerr << "ERROR: archiveEviction = " << archive_eviction_name << " not recognized." << std::endl;
+        exit(1);
+    }
+    archive_eviction.set_limits(settings::getParameter<settings::Integer>(parameters,"#archiveMaxSize").value,
+                                settings::getParameter<settings::Double>(parameters,"#archiveCellSize").value);
+    // read once, finish_eval compares them at every check
+    target_position[0] = settings::getParameter<settings::Double>(parameters,"#target_x").value;
+    target_position[1] = settings::getParameter<settings::Double>(parameters,"#target_y").value;
+    target_position[2] = settings::getParameter<settings::Double>(parameters,"#target_z").value;
+    target_distance = settings::getParameter<settings::Double>(parameters,"#FTarget").value;
+    arena_size = settings::getParameter<settings::Double>(parameters,"#arenaSize").value;
     int lenStag = settings::getParameter<settings::Integer>(parameters,"#lengthOfStagnation").value;
 
     int pop_size = settings::getParameter<settings::Integer>(parameters,"#populationSize").value;
@@ -212,54 +278,17 @@ void NIPES::init(){
         set_currentMaxEvalTime(og_maxEvalTime);
     }
 
-
-
-
-
-    if (subexperiment_name == "halving")
-    {
-        n_of_halvings = 1.0 + log2((double)settings::getParameter<settings::Integer>(parameters, "#populationSize").value);
-        std::cout << "n_of_halvings: " << n_of_halvings << std::endl;
-        std::cout << "pop_size: " << pop_size << std::endl;
-
-
-        for (size_t i = 0; i < n_of_halvings; i++)
-        {
-            time_checkpoints[i] = pow(0.5, n_of_halvings - 1 - i) * settings::getParameter<settings::Float>(parameters, "#maxEvalTime").value;
-        }
-
-        // Update fitness checkpoints after first iteration.
-        update_fitness_checkpoints = true;
-
-        // Set all fitness checkpoints to minus infinity so that the observed_fitnesse
-        // is computed for all controllers in first iteration.
-        std::fill_n(fitness_checkpoints, 20, -1e20);
-        finish_eval_array.resize(pop_size);
-        for (size_t i = 0; i < pop_size; i++)
-        {
-            finish_eval_array[i] = false;
-        }
-        savefCheckpoints();
-    }
-
-    if (subexperiment_name == "bestasref")
-    {
-        // Update fitness checkpoints after first iteration.
-        update_fitness_checkpoints = true;
-        std::fill_n(bestasref_ref_fitnesses, BESTASREF_FITNESS_ARRAY_SIZE, -__DBL_MAX__);
-        float time_delta = settings::getParameter<settings::Float>(parameters, "#timeStep").value;
-        bestasref_size_of_fitnesses = lround(og_maxEvalTime / time_delta);
-        finish_eval_array.resize(pop_size);
-        for (size_t i = 0; i < pop_size; i++)
-        {
-            finish_eval_array[i] = false;
-        }
-        savefCheckpoints();
-    }
+    // a single instance evaluates its own population, the threshold curves need no file
+    in_process = instance_type == 0;
+    early_stopping->set_in_process(in_process);
+    early_stopping->init(parameters, pop_size);
+    sample_rank_agreement_individuals();
+    record_measure_ranks_curves();
+    prepare_population();
 }
 
 
-void NIPES::write_measure_ranks_to_results()
+void NIPES::write_measure_ranks_to_results(double runtime)
 {
     std::vector<double> f_scores(population.size());
     std::vector<double> ranks(population.size());
@@ -268,7 +297,7 @@ void NIPES::write_measure_ranks_to_results()
     {   
         auto ind = population[i];
         double fitness;
-        fitness = std::dynamic_pointer_cast<NIPESIndividual>(ind)->getObjectives()[0];
+        fitness = std::dynamic_pointer_cast<NIPESIndividual>(ind)->fitness_at_runtime(runtime, time_delta);
         f_scores[i] = fitness;
     }
 
@@ -280,7 +309,7 @@ void NIPES::write_measure_ranks_to_results()
     std::stringstream res_to_write;
     res_to_write << std::setprecision(28);
     res_to_write << settings::getParameter<settings::String>(parameters,"#preTextInResultFile").value << ",";
-    res_to_write << get_currentMaxEvalTime()<< ",";
+    res_to_write << runtime << ",";
     res_to_write << numberEvaluation << ",";
     res_to_write << "(";
     res_to_write << iterable_to_str(ranks.begin(), ranks.end());
@@ -312,21 +341,67 @@ void NIPES::updateNoveltyEnergybudgetArchive()
             Novelty::k_value = population.size()/2;
         else Novelty::k_value = settings::getParameter<settings::Integer>(parameters,"#kValue").value;
 
-        std::vector<Eigen::VectorXd> pop_desc;
+        // The scores only read the archive, they are computed in parallel then added in the order of the
+        // population. The archive is updated serially afterwards, so the draws of randomNum do not change.
+        std::vector<double> novelties(population.size());
+
+        // Visited zones are compared directly on their bits
+        bool grid_descriptors = archive.size() == grid_archive.size();
         for(const auto& ind : population)
-            pop_desc.push_back(ind->descriptor());
-        //compute novelty
-        for(const auto& ind : population){
-            Eigen::VectorXd ind_desc = ind->descriptor();
-            double ind_nov = Novelty::sparseness(Novelty::distances(ind_desc,archive,pop_desc));
-            std::dynamic_pointer_cast<sim::NN2Individual>(ind)->addObjective(ind_nov);
-        }
+            grid_descriptors = grid_descriptors && std::dynamic_pointer_cast<NIPESIndividual>(ind)->get_descriptor_type() == VISITED_ZONES;
+
+        if(grid_descriptors){
+            GridBlock pop_grids;
+            for(const auto& ind : population)
+                pop_grids.push_back(std::dynamic_pointer_cast<NIPESIndividual>(ind)->get_visited_zones());
+            //compute novelty
+            tbb::parallel_for(tbb::blocked_range<size_t>(0,population.size()),[&](const tbb::blocked_range<size_t>& range){
+                for(size_t i = range.begin(); i < range.end(); i++){
+                    const VisitedGrid& grid = std::dynamic_pointer_cast<NIPESIndividual>(population[i])->get_visited_zones();
+                    novelties[i] = grid_sparseness(grid,grid_archive,pop_grids,Novelty::k_value);
+                }
+            });
+        }else{
+            size_t desc_size = std::dynamic_pointer_cast<NIPESIndividual>(population[0])->get_descriptor().size();
+            pop_descriptors.resize(desc_size,population.size());
+            for(size_t i = 0; i < population.size(); i++)
+                pop_descriptors.col(i) = std::dynamic_pointer_cast<NIPESIndividual>(population[i])->get_descriptor();
+            if(archive_index.size() != archive.size())
+                archive_index.rebuild(archive);
+            //compute novelty
+            tbb::parallel_for(tbb::blocked_range<size_t>(0,population.size()),[&](const tbb::blocked_range<size_t>& range){
+                for(size_t i = range.begin(); i < range.end(); i++)
+                    novelties[i] = archive_index.sparseness(pop_descriptors.col(i),pop_descriptors,Novelty::k_value);
+            });
+        }
+        for(size_t i = 0; i < population.size(); i++)
+            std::dynamic_pointer_cast<sim::NN2Individual>(population[i])->addObjective(novelties[i]);
 
         //update archive
         for(const auto& ind : population){
-            Eigen::VectorXd ind_desc = ind->descriptor();
+            const Eigen::VectorXd& ind_desc = std::dynamic_pointer_cast<NIPESIndividual>(ind)->get_descriptor();
             double ind_nov = ind->getObjectives().back();
+            size_t archive_size = archive.size();
             Novelty::update_archive(ind_desc,ind_nov,archive,randomNum);
+            if(archive.size() == archive_size)
+                continue;
+            bool index_synced = archive_index.size() == archive_size;
+            // with #archiveMaxSize, the descriptor may take the slot of an evicted one or be dropped
+            int slot = archive_eviction.on_insert(archive,ind_nov,randomNum);
+            if(slot < 0)
+                continue;
+            const VisitedGrid& zones = std::dynamic_pointer_cast<NIPESIndividual>(ind)->get_visited_zones();
+            if(static_cast<size_t>(slot) == archive_size){
+                if(index_synced)
+                    archive_index.insert(archive.back());
+                if(grid_descriptors)
+                    grid_archive.push_back(zones);
+            }else{
+                if(index_synced)
+                    archive_index.replace(slot,archive[slot]);
+                if(grid_descriptors)
+                    grid_archive.set(slot,zones);
+            }
         }
     }
 
@@ -378,355 +453,235 @@ void NIPES::cma_iteration(){
 
 void NIPES::modifyMaxEvalTime_iteration()
 {
-        static const int maxNbrEval = settings::getParameter<settings::Integer>(parameters,"#maxNbrEval").value;
         static const double minEvalTime = (double) settings::getParameter<settings::Float>(parameters,"#minEvalTime").value;
         static const double constantmodifyMaxEvalTime = (double) settings::getParameter<settings::Float>(parameters,"#constantmodifyMaxEvalTime").value;
-        double progress = (double) numberEvaluation / (double) maxNbrEval;
+        static const bool adaptiveMaxEvalTime = settings::getParameter<settings::Boolean>(parameters,"#adaptiveMaxEvalTime").value;
+        if (adaptiveMaxEvalTime)
+        {
+            rank_agreement_iteration();
+            return;
+        }
+        double progress = budget_progress();
         // std::cout << "progress: " << progress << std::endl;
         // std::cout << "(progress, constantmodifyMaxEvalTime, (double) (og_maxEvalTime - minEvalTime)) = (" << progress << "," << constantmodifyMaxEvalTime << "," << (double) (og_maxEvalTime - minEvalTime) << ")" << std::endl;
         // std::cout << "get_adjusted_runtime()" << get_adjusted_runtime(progress, constantmodifyMaxEvalTime, (double) (og_maxEvalTime - minEvalTime)) << std::endl;
         set_currentMaxEvalTime(minEvalTime + get_adjusted_runtime(progress, constantmodifyMaxEvalTime, (double) (og_maxEvalTime - minEvalTime)));
 }
 
-void NIPES::print_fitness_iteration()
+void NIPES::sample_rank_agreement_individuals()
 {
-    for (const auto &ind : population)
+    static const bool adaptiveMaxEvalTime = settings::getParameter<settings::Boolean>(parameters,"#adaptiveMaxEvalTime").value;
+    static const int sample_size = settings::getParameter<settings::Integer>(parameters,"#rankAgreementSampleSize").value;
+    static const int every_n_gens = settings::getParameter<settings::Integer>(parameters,"#rankAgreementEveryNGens").value;
+    if (!adaptiveMaxEvalTime || !modify_max_eval_time || early_stopping->stops_early() || generation % every_n_gens != 0)
     {
-        std::cout << "objective, novelty: " << iterable_to_str(std::dynamic_pointer_cast<NIPESIndividual>(ind)->getObjectives().begin(), std::dynamic_pointer_cast<NIPESIndividual>(ind)->getObjectives().end()) << std::endl;
-        double fitness;
-        fitness = std::dynamic_pointer_cast<NIPESIndividual>(ind)->getObjectives()[0];
-
-        if (fitness > best_fitness)
-        {
-            best_fitness = fitness;
-        }
+        return;
     }
-}
 
-std::string NIPES::compute_population_genome_hash()
-{
-    std::ostringstream strs;
-    // strs << std::setprecision(0);
-    for (const auto &ind : population)
+    // partial Fisher-Yates shuffle, the first sample_size indexes are the sample
+    std::vector<int> indexes(population.size());
+    for (size_t i = 0; i < indexes.size(); i++)
     {
-        strs << "#" << getIndividualHash(ind);
+        indexes[i] = i;
+    }
+    int n = std::min<int>(sample_size, indexes.size());
+    for (int i = 0; i < n; i++)
+    {
+        int j = std::min<int>(indexes.size() - 1, i + (int)(randomNum->randFloat(0, 1) * (indexes.size() - i)));
+        std::swap(indexes[i], indexes[j]);
+        auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(population[indexes[i]]);
+        NIPESind->set_max_eval_time(og_maxEvalTime);
+        NIPESind->context.record_curve = true;
     }
-    std::string str = strs.str();
-    return str;
 }
 
-void NIPES::loadfCheckpoints()
+void NIPES::rank_agreement_iteration()
 {
+    static const double minEvalTime = (double) settings::getParameter<settings::Float>(parameters,"#minEvalTime").value;
+    static const double threshold = settings::getParameter<settings::Double>(parameters,"#rankAgreementThreshold").value;
 
-    // std::ifstream in("fitness_checkpoints.data", std::ios::in | std::ios::binary);
-    // in.read((char *)&fitness_checkpoints, sizeof fitness_checkpoints);
-
-    // // see how many bytes have been read
-    // std::cout << in.gcount() << " bytes read\n";
-    // in.close();
-
-
-    // std::cout << "loaded fitness_checkpoints: ";
-    // PrintArray(fitness_checkpoints, n_of_halvings);
-
-    if (subexperiment_name == "halving")
+    std::vector<NIPESIndividual*> sample;
+    for (const auto &ind : population)
     {
-        // halving
-        for (size_t i = 0; i < n_of_halvings; i++)
+        auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
+        if (NIPESind->context.record_curve)
         {
-            auto ind = population[currentIndIndex];
-            auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
-            fitness_checkpoints[i] = NIPESind->fitness_checkpoints[i];
+            sample.push_back(NIPESind.get());
         }
     }
-
-    if (subexperiment_name == "bestasref")
+    if (sample.empty())
     {
-        // bestasref
-        for (size_t i = 0; i < bestasref_size_of_fitnesses; i++)
-        {
-            auto ind = population[currentIndIndex];
-            auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
-            bestasref_ref_fitnesses[i] = NIPESind->bestasref_ref_fitnesses[i];
-        }
+        return;
     }
-}
 
-void NIPES::bestasrefGetfCheckpointsFromIndividual(int individualIndex)
-{
-        const double EPSILON = 0.0000001;
-        auto ind = population[individualIndex];
-        auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
-        double fitness = NIPESind->getObjectives()[0];
-        if (abs(fitness - best_fitness) < EPSILON)
+    // shortest runtime from which every longer runtime ranks the sample as the full runtime does
+    double new_max_eval_time = og_maxEvalTime;
+    // Kendall tau needs a few pairs to mean anything, a smaller sample keeps the runtime
+    if (sample.size() >= 3)
+    {
+        std::vector<double> full_fitnesses(sample.size());
+        std::vector<double> truncated_fitnesses(sample.size());
+        for (size_t j = 0; j < sample.size(); j++)
         {
-            std::cout << "We DO NOT relaxing best fitness refs if fitness is equal to bk." << std::endl;
-
-            // std::cout << "Relaxing best fitness refs" << std::endl;
-            // PrintArray(NIPESind->bestasref_observed_fitnesses, bestasref_size_of_fitnesses);
-            // std::cout << "    -     " << std::endl;
-            // PrintArray(bestasref_ref_fitnesses, bestasref_size_of_fitnesses);
-            // std::cout << "* * *" << std::endl;
-
-            // for (size_t i = 0; i < bestasref_size_of_fitnesses; i++)
-            // {
-            //     // min() makes the stopping criteria less and less strict
-            //     bestasref_ref_fitnesses[i] = std::min(bestasref_ref_fitnesses[i], NIPESind->bestasref_observed_fitnesses[i]);
-
-            //     // // max() makes the stopping criteria more and more strict
-            //     // bestasref_ref_fitnesses[i] = std::max(bestasref_ref_fitnesses[i], NIPESind->bestasref_observed_fitnesses[i]);
-            // }
+            full_fitnesses[j] = sample[j]->getObjectives()[0];
         }
-        else if (fitness > best_fitness)
+        for (double runtime = og_maxEvalTime - time_delta; runtime >= minEvalTime - time_delta / 2; runtime -= time_delta)
         {
-            std::cout << "Updating fitnesses due to new best fitness." << std::endl;
-            PrintArray(NIPESind->bestasref_observed_fitnesses, bestasref_size_of_fitnesses);
-            std::cout << "    -     " << std::endl;
-            PrintArray(bestasref_ref_fitnesses, bestasref_size_of_fitnesses);
-            std::cout << "* * *" << std::endl;
-
-            best_fitness = fitness;
-            for (size_t i = 0; i < bestasref_size_of_fitnesses; i++)
+            for (size_t j = 0; j < sample.size(); j++)
             {
-                bestasref_ref_fitnesses[i] = NIPESind->bestasref_observed_fitnesses[i];
+                truncated_fitnesses[j] = sample[j]->fitness_at_runtime(runtime, time_delta);
             }
-        }
-
-}
-
-
-void NIPES::getfCheckpointsFromIndividuals()
-{
-    // halving
-    std::cout << "getfCheckpointsFromIndividuals(): " << std::endl;
-
-    if (subexperiment_name == "halving")
-    {
-        double fitnesses[n_of_halvings][pop_size];
-        for (size_t j = 0; j < pop_size; j++)
-        {
-            auto ind = population[j];
-            auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
-            for (size_t i = 0; i < n_of_halvings; i++)
+            if (kendall_tau(truncated_fitnesses, full_fitnesses) < threshold)
             {
-                fitnesses[i][j] = NIPESind->observed_fintesses[i];
-                std::cout << NIPESind->observed_fintesses[i] << ",";
+                break;
             }
-            std::cout << std::endl;
-        }
-
-        for (size_t i = 0; i < n_of_halvings; i++)
-        {
-            std::sort(fitnesses[i], fitnesses[i] + pop_size);
-            int position = (int)((1.0 - pow(0.5, i + 1)) * (double)(pop_size - 1));
-            fitness_checkpoints[i] = fitnesses[i][position];
+            new_max_eval_time = runtime;
         }
-        std::cout << std::endl;
+    }
+    else
+    {
+        new_max_eval_time = get_currentMaxEvalTime();
     }
 
-    if (subexperiment_name == "bestasref")
+    // the sample is ranked, and its novelty scored, with the rest of the generation on the runtime the others had
+    for (auto ind : sample)
     {
-        // bestasref
-        for (size_t j = 0; j < pop_size; j++)
-        {
-            bestasrefGetfCheckpointsFromIndividual(j);
-        }
+        ind->setObjectives({ind->fitness_at_runtime(get_currentMaxEvalTime(), time_delta)});
+        ind->use_generation_behaviour();
     }
+
+    std::cout << "Rank agreement: maxEvalTime " << get_currentMaxEvalTime() << " -> " << new_max_eval_time << std::endl;
+    set_currentMaxEvalTime(new_max_eval_time);
 }
 
-void NIPES::savefCheckpoints()
+void NIPES::record_measure_ranks_curves()
 {
-
-    //     std::cout << "saving fitness_checkpoints: " << std::endl;
-    //     PrintArray(fitness_checkpoints, n_of_halvings);
-
-    //     std::ofstream out("fitness_checkpoints.data", std::ios::out | std::ios::binary);
-    //     if (!out)
-    //     {
-    //         std::cout << "Cannot open file 'fitness_checkpoints.data' on write mode. Exit...";
-    //         exit(1);
-    //     }
-
-    //   out.write((char *) &fitness_checkpoints, sizeof fitness_checkpoints);
-    //   out.close();
-
-    if (subexperiment_name == "halving")
+    if (subexperiment_name != "measure_ranks")
     {
-
-        // halving
-        for (size_t j = 0; j < pop_size; j++)
-        {
-            auto ind = population[j];
-            for (size_t i = 0; i < n_of_halvings; i++)
-            {
-                auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
-                NIPESind->fitness_checkpoints[i] = fitness_checkpoints[i];
-            }
-        }
+        return;
+    }
+    for (const auto &ind : population)
+    {
+        std::dynamic_pointer_cast<NIPESIndividual>(ind)->context.record_curve = true;
     }
+}
 
-    if (subexperiment_name == "bestasref")
+void NIPES::print_fitness_iteration()
+{
+    for (const auto &ind : population)
     {
-        // bestasref
-        for (size_t j = 0; j < pop_size; j++)
+        std::cout << "objective, novelty: " << iterable_to_str(std::dynamic_pointer_cast<NIPESIndividual>(ind)->getObjectives().begin(), std::dynamic_pointer_cast<NIPESIndividual>(ind)->getObjectives().end()) << std::endl;
+        double fitness;
+        fitness = std::dynamic_pointer_cast<NIPESIndividual>(ind)->getObjectives()[0];
+
+        if (fitness > best_fitness)
         {
-            auto ind = population[j];
-            for (size_t i = 0; i < bestasref_size_of_fitnesses; i++)
-            {
-                auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
-                NIPESind->bestasref_ref_fitnesses[i] = bestasref_ref_fitnesses[i];
-            }
+            best_fitness = fitness;
         }
     }
 }
 
-void NIPES::epoch(){
-
-    if (pop_size == 0)
+std::string NIPES::compute_population_genome_hash()
+{
+    std::ostringstream strs;
+    // strs << std::setprecision(0);
+    for (const auto &ind : population)
     {
-        return;
+        strs << "#" << getIndividualHash(ind);
     }
+    std::string str = strs.str();
+    return str;
+}
 
-    const static std::string preTextInResultFile = settings::getParameter<settings::String>(parameters,"#preTextInResultFile").value;
-    std::cout << "- epoch(), " << "preTextInResultFile=" << preTextInResultFile << ", maxruntime=" << get_currentMaxEvalTime()<< ", evals=" << numberEvaluation <<", isReeval=" << isReevaluating << ", gen = " << get_generation() << ", time=" << std::time(nullptr) << std::endl;
-
-
-    if (subexperiment_name == "halving")
+void NIPES::prepare_population()
+{
+    first_unsent = 0;
+    for (const auto &ind : population)
     {
-        for (size_t j = 0; j < pop_size; j++)
-        {
-            auto ind = population[j];
-            auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
-            total_time_simulating += NIPESind->consumed_runtime;
-        }
-
-        if (update_fitness_checkpoints)
-        {
-            getfCheckpointsFromIndividuals();
-            savefCheckpoints();
-            update_fitness_checkpoints = false;
-        }
-
-        const int UPDATE_F_CHECKPOINTS_EVERY_N_GENS = 10;
-        if ((generation+1) % UPDATE_F_CHECKPOINTS_EVERY_N_GENS == 0)
-        {
-            std::cout << "Updating fitness checkpoints in next generation...";
-            update_fitness_checkpoints = true;
-            std::fill_n(fitness_checkpoints, 20, -1e20);
-            savefCheckpoints();
-        }
-
-        write_results();
-        updateNoveltyEnergybudgetArchive();
-        cma_iteration();
-        print_fitness_iteration();
-        for (size_t i = 0; i < pop_size; i++)
-        {
-            finish_eval_array[i] = false;
-        }
-        
-        return;
+        early_stopping->prepare_individual(std::dynamic_pointer_cast<NIPESIndividual>(ind)->context);
     }
+}
 
+void NIPES::epoch(){
 
-    if (subexperiment_name == "bestasref")
+    if (pop_size == 0)
     {
-        for (size_t j = 0; j < pop_size; j++)
-        {
-            auto ind = population[j];
-            auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
-            total_time_simulating += NIPESind->consumed_runtime;
-        }
-
-        if (update_fitness_checkpoints)
-        {
-            getfCheckpointsFromIndividuals();
-            savefCheckpoints();
-            update_fitness_checkpoints = false;
-        }
-
-
-
-        write_results();
-        updateNoveltyEnergybudgetArchive();
-        cma_iteration();
-        print_fitness_iteration();
-        for (size_t i = 0; i < pop_size; i++)
-        {
-            finish_eval_array[i] = false;
-        }
-        
         return;
     }
 
+    const static std::string preTextInResultFile = settings::getParameter<settings::String>(parameters,"#preTextInResultFile").value;
+    std::cout << "- epoch(), " << "preTextInResultFile=" << preTextInResultFile << ", maxruntime=" << get_currentMaxEvalTime()<< ", evals=" << numberEvaluation << ", gen = " << get_generation() << ", time=" << std::time(nullptr) << std::endl;
 
 
     if (subexperiment_name == "measure_ranks")
     {   
-        const int REEVALUATE_EVERY_N_GENS = 10;
+        // The evaluation is deterministic, the fitness after each of RUNTIMES is read from the curve of
+        // the full evaluation instead of evaluating the population again for each runtime.
+        const int MEASURE_RANKS_EVERY_N_GENS = 10;
         const int N_LINSPACE_SAMPLES_RUNTIME = 6;
         const double RUNTIMES[N_LINSPACE_SAMPLES_RUNTIME] = {0.9, 1.8, 3.7, 7.5, 15.0, 30.0};
-        if (generation % REEVALUATE_EVERY_N_GENS == 0)
+        if (generation % MEASURE_RANKS_EVERY_N_GENS == 0)
         {
-            std::cout << "MaxEvalTime: " << RUNTIMES[n_iterations_isReevaluating] << std::endl;
-            write_measure_ranks_to_results();
-            set_currentMaxEvalTime(RUNTIMES[n_iterations_isReevaluating]);
-            isReevaluating = n_iterations_isReevaluating < N_LINSPACE_SAMPLES_RUNTIME;
-            if(isReevaluating)
+            write_measure_ranks_to_results(get_currentMaxEvalTime());
+            for (int i = 0; i < N_LINSPACE_SAMPLES_RUNTIME; i++)
             {
-                std::cout << "- Reevaluating... " << std::endl;
+                std::cout << "MaxEvalTime: " << RUNTIMES[i] << std::endl;
+                write_measure_ranks_to_results(RUNTIMES[i]);
             }
         }
-        if (isReevaluating)
-        {
-            set_generation(get_generation() - 1);
-            generation = get_generation();
-            numberEvaluation -= population.size();
-            n_iterations_isReevaluating++;
-        }
-        else
-        {
-            n_iterations_isReevaluating = 0;
-            updateNoveltyEnergybudgetArchive();
-            cma_iteration();
-            set_currentMaxEvalTime(RUNTIMES[N_LINSPACE_SAMPLES_RUNTIME-1]);
-        }
+        updateNoveltyEnergybudgetArchive();
+        cma_iteration();
+        set_currentMaxEvalTime(RUNTIMES[N_LINSPACE_SAMPLES_RUNTIME-1]);
         print_fitness_iteration();
         return;
 
     }
 
 
-    if (subexperiment_name == "standard")
+    double simulated_time_before = total_time_simulating;
+    if (early_stopping->stops_early())
     {
-        total_time_simulating += pop_size * get_currentMaxEvalTime();
+        for (const auto &ind : population)
+        {
+            total_time_simulating += std::dynamic_pointer_cast<NIPESIndividual>(ind)->context.consumed_runtime;
+        }
+    }
+    else
+    {
+        for (const auto &ind : population)
+        {
+            total_time_simulating += std::dynamic_pointer_cast<NIPESIndividual>(ind)->get_max_eval_time();
+        }
         static const bool modifyMaxEvalTime = settings::getParameter<settings::Boolean>(parameters, "#modifyMaxEvalTime").value;
         if (modifyMaxEvalTime)
         {
             modifyMaxEvalTime_iteration();
         }
-        write_results();
-        updateNoveltyEnergybudgetArchive();
-        cma_iteration();
-        print_fitness_iteration();
-        return;
     }
 
+    last_generation_simulated_time = total_time_simulating - simulated_time_before;
+    double wall_time = total_time_sw.toc();
+    last_generation_wall_time = wall_time - wall_time_at_last_epoch;
+    wall_time_at_last_epoch = wall_time;
 
+    std::vector<EvalResult> results;
+    for (const auto& ind : population)
+        results.push_back({&std::dynamic_pointer_cast<NIPESIndividual>(ind)->context, ind->getObjectives()[0]});
+    early_stopping->on_epoch(results, generation, best_fitness);
 
-
+    write_results();
+    updateNoveltyEnergybudgetArchive();
+    cma_iteration();
+    print_fitness_iteration();
 }
 
 void NIPES::init_next_pop(){
 
-    if (!isReevaluating)
-    {
-        new_samples = cmaStrategy->ask();
-        nbr_weights = std::dynamic_pointer_cast<NNParamGenome>(population[0]->get_ctrl_genome())->get_weights().size();
-        nbr_bias = std::dynamic_pointer_cast<NNParamGenome>(population[0]->get_ctrl_genome())->get_biases().size();
-        weights.resize(nbr_weights);
-        biases.resize(nbr_bias);
-    }
+    new_samples = cmaStrategy->ask();
+    nbr_weights = std::dynamic_pointer_cast<NNParamGenome>(population[0]->get_ctrl_genome())->get_weights().size();
+    nbr_bias = std::dynamic_pointer_cast<NNParamGenome>(population[0]->get_ctrl_genome())->get_biases().size();
+    weights.resize(nbr_weights);
+    biases.resize(nbr_bias);
     pop_size = cmaStrategy->get_parameters().lambda();
     double tmp_currentMaxEvalTime = get_currentMaxEvalTime(); 
     population.clear();
@@ -747,7 +702,9 @@ void NIPES::init_next_pop(){
         population.push_back(ind);
     }
     set_currentMaxEvalTime(tmp_currentMaxEvalTime);
-    savefCheckpoints();
+    sample_rank_agreement_individuals();
+    record_measure_ranks_curves();
+    prepare_population();
 }
 
 void NIPES::setObjectives(size_t indIdx, const std::vector<double> &objectives){
@@ -770,31 +727,39 @@ bool NIPES::update(const Environment::Ptr & env){
     sw.tic();
     numberEvaluation++;
     if(simulator_side){
+        watchdog.end_eval();
         Individual::Ptr ind = population[currentIndIndex];
         std::cout << "- Evaluated genome with hash #" << getIndividualHash(ind);
         std::dynamic_pointer_cast<NIPESIndividual>(ind)->set_final_position(env->get_final_position());
-        std::dynamic_pointer_cast<NIPESIndividual>(ind)->set_trajectory(env->get_trajectory());
+        uint64_t traj_hash = FNV_OFFSET_BASIS;
         if(env->get_name() == "obstacle_avoidance"){
-            std::dynamic_pointer_cast<NIPESIndividual>(ind)->set_visited_zones(std::dynamic_pointer_cast<sim::ObstacleAvoidance>(env)->get_visited_zone_matrix());
+            auto oa_env = std::dynamic_pointer_cast<sim::ObstacleAvoidance>(env);
+            traj_hash = oa_env->get_trajectory_hash();
+            std::dynamic_pointer_cast<NIPESIndividual>(ind)->take_trajectory(oa_env->release_trajectory());
+            std::dynamic_pointer_cast<NIPESIndividual>(ind)->set_visited_zones(oa_env->get_visited_zones());
             std::dynamic_pointer_cast<NIPESIndividual>(ind)->set_descriptor_type(VISITED_ZONES);
+        }else{
+            std::dynamic_pointer_cast<NIPESIndividual>(ind)->set_trajectory(env->get_trajectory());
+            for (const waypoint &wp : env->get_trajectory())
+                traj_hash = sim::ObstacleAvoidance::hash_waypoint(wp, traj_hash);
         }
-    std:: cout << ", fitness: " << ind->getObjectives()[0] << ", runtime: " << get_currentMaxEvalTime()<< ", traj of length " ;
-    
-    std::string traj = "";
-    for (size_t i = 0; i < env->get_trajectory().size(); i++)
-    {
-        traj+= env->get_trajectory()[i].to_string();
-
-    }
-    std::cout << env->get_trajectory().size() << " and hash #" << hash_string(traj) << std::endl;
+        std::dynamic_pointer_cast<NIPESIndividual>(ind)->cache_descriptor();
+    std:: cout << ", fitness: " << ind->getObjectives()[0] << ", runtime: " << std::dynamic_pointer_cast<NIPESIndividual>(ind)->get_max_eval_time() << ", traj of length " ;
+    std::cout << std::dynamic_pointer_cast<NIPESIndividual>(ind)->get_trajectory().size() << " and hash #" << std::hex << traj_hash << std::dec << std::endl;
     }
     sw.tic();
 
-    if(subexperiment_name == "bestasref")
+    early_stopping->on_eval_end(std::dynamic_pointer_cast<NIPESIndividual>(population[currentIndIndex])->context,
+                                population[currentIndIndex]->getObjectives()[0], best_fitness);
+    // the simulators get the individuals in the order of the population, the ones up to this one are already sent
+    if (early_stopping->updates_per_evaluation() && !in_process)
     {
-        bestasrefGetfCheckpointsFromIndividual(currentIndIndex);
+        first_unsent = std::max<size_t>(first_unsent, currentIndIndex + 1);
+        for (size_t i = first_unsent; i < population.size(); i++)
+        {
+            early_stopping->prepare_individual(std::dynamic_pointer_cast<NIPESIndividual>(population[i])->context);
+        }
     }
-    
 
     return true;
 }
@@ -825,14 +790,14 @@ void NIPES::write_results()
     res_to_write << ",";
     res_to_write << numberEvaluation;
 
-    if(subexperiment_name == "halving" || subexperiment_name == "bestasref")
+    if(early_stopping->stops_early())
     {
         res_to_write << ",(";
         for (size_t j = 0; j < pop_size; j++)
         {
             auto ind = population[j];
             auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(ind);
-            res_to_write <<  NIPESind->consumed_runtime << ";";
+            res_to_write <<  NIPESind->context.consumed_runtime << ";";
         }
         res_to_write << ")";
     }
@@ -842,11 +807,39 @@ void NIPES::write_results()
 }
 
 
+double NIPES::budget_progress()
+{
+    static const int maxNbrEval = settings::getParameter<settings::Integer>(parameters,"#maxNbrEval").value;
+    static const double maxSimulatedTime = settings::getParameter<settings::Double>(parameters,"#maxSimulatedTime").value;
+    static const double maxWallTime = settings::getParameter<settings::Double>(parameters,"#maxWallTime").value;
+
+    double progress = (double) numberEvaluation / (double) maxNbrEval;
+    if (maxSimulatedTime > 0)
+    {
+        progress = std::max(progress, total_time_simulating / maxSimulatedTime);
+    }
+    if (maxWallTime > 0)
+    {
+        progress = std::max(progress, total_time_sw.toc() / maxWallTime);
+    }
+    return progress;
+}
+
 bool NIPES::is_finish(){
     int maxNbrEval = settings::getParameter<settings::Integer>(parameters,"#maxNbrEval").value;
+    double maxSimulatedTime = settings::getParameter<settings::Double>(parameters,"#maxSimulatedTime").value;
+    double maxWallTime = settings::getParameter<settings::Double>(parameters,"#maxWallTime").value;
+
+    // A time budget is exhausted if the next generation, costing as much as the last one, would exceed it.
+    bool simulated_time_exhausted = maxSimulatedTime > 0 && total_time_simulating + last_generation_simulated_time > maxSimulatedTime;
+    bool wall_time_exhausted = maxWallTime > 0 && total_time_sw.toc() + last_generation_wall_time > maxWallTime;
 
-    if (numberEvaluation > maxNbrEval + population.size() && !isReevaluating)
+    if ((numberEvaluation > maxNbrEval + population.size() || simulated_time_exhausted || wall_time_exhausted))
     {
+        if (simulated_time_exhausted)
+            std::cout << "Simulated time budget exhausted: " << total_time_simulating << std::endl;
+        if (wall_time_exhausted)
+            std::cout << "Wall time budget exhausted: " << total_time_sw.toc() << std::endl;
         std::cout << "numberEvaluation: " << numberEvaluation << std::endl;
         std::cout << "maxNbrEval: " << maxNbrEval << std::endl;
 
@@ -862,105 +855,81 @@ bool NIPES::is_finish(){
     }
 }
 
+void NIPES::record_generation_behaviour(const Environment::Ptr &env, NIPESIndividual &ind)
+{
+    sim::ObstacleAvoidanceState behaviour;
+    if (env->get_name() == "obstacle_avoidance")
+    {
+        std::static_pointer_cast<sim::ObstacleAvoidance>(env)->save_state(behaviour);
+    }
+    else
+    {
+        float pos[3];
+        simGetObjectPosition(robot_handle,-1,pos);
+        behaviour.final_position = {pos[0],pos[1],pos[2]};
+        behaviour.trajectory = env->get_trajectory();
+    }
+    ind.set_generation_behaviour(std::move(behaviour));
+}
+
 bool NIPES::finish_eval(const Environment::Ptr &env){
 
     // std::cout << "simGetSimulationTime()" << simGetSimulationTime() << std::endl;
 
-    static const bool modifyMaxEvalTime = settings::getParameter<settings::Boolean>(parameters,"#modifyMaxEvalTime").value;
+    double sim_time = simGetSimulationTime();
+    // population only holds NIPESIndividual, avoid a dynamic cast at every tick
+    NIPESIndividual &ind = *static_cast<NIPESIndividual*>(population[currentIndIndex].get());
+    EvalContext &ctx = ind.context;
 
-    // we need an offset of 0.3 seconds, because the simulation will halt the third
-    // time true is returned.
-    // static long unsigned int checks = 0;
-    // checks++;
-
-    // Save fitness and check if stopping is necessary
-    if (subexperiment_name == "halving" || subexperiment_name == "bestasref")
+    // in the first iteration
+    if (sim_time < time_step*1.5)
     {
-        static float time_delta = settings::getParameter<settings::Float>(parameters, "#timeStep").value;
-
-        // in the first iteration
-        if (simGetSimulationTime() < time_delta*1.5)
+        // the morphology is built for the evaluation, its handle holds until the next one
+        robot_handle = std::static_pointer_cast<sim::Morphology>(ind.get_morphology())->getMainHandle();
+        // in process, the individual is prepared when its evaluation starts
+        if (in_process && early_stopping->updates_per_evaluation())
         {
-            finish_eval_array[currentIndIndex] = false;
-            tick = 0;
-        }
-
-        // need to return true 3 times to really stop.
-        if (finish_eval_array[currentIndIndex])
-        {
-            return true;
+            early_stopping->prepare_individual(ctx);
         }
+        ctx.start();
+        early_stopping->on_eval_start(ctx);
+        watchdog.start_eval(ind.get_max_eval_time(), sim_time);
+    }
+    watchdog.tick(sim_time);
 
-        if (subexperiment_name == "halving")
-        {
-            int checkpointIndex = -1;
-            for (size_t i = 0; i < n_of_halvings; i++)
-            {
-                // If current runtime is same as checkpoint runtime...
-                if (time_checkpoints[i] - time_delta / 2 <= simGetSimulationTime() + 0.3 && simGetSimulationTime() + 0.3 < time_checkpoints[i] + time_delta / 2)
-                {
-                    checkpointIndex = i;
-                    break;
-                }
-            }
+    // the individuals sampled by the rank agreement run longer than the rest of their generation
+    if (ctx.record_curve && !ind.has_generation_behaviour() && ind.get_max_eval_time() > ind.get_generation_eval_time() &&
+        sim_time + time_step / 2 >= ind.get_generation_eval_time())
+    {
+        record_generation_behaviour(env, ind);
+    }
 
-            if (checkpointIndex >= 0)
-            {
-                // save current used runtime
-                loadfCheckpoints();
-
-                // save fitness
-                auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(population[currentIndIndex]);
-                NIPESind->observed_fintesses[checkpointIndex] = getFitness(env);
-                NIPESind->consumed_runtime = simGetSimulationTime() + 0.3;
-                std::cout << "NIPESind->fitness_checkpoints: ";
-                PrintArray(fitness_checkpoints, n_of_halvings);
-                std::cout << "time_checkpoints: ";
-                PrintArray(time_checkpoints, n_of_halvings);
-
-                // check if should stop bc fitness lower than fitness checkpoint
-                std::cout << "getFitness(env) < NIPESind->fitness_checkpoints[checkpointIndex]: " << getFitness(env) << " " << fitness_checkpoints[checkpointIndex] << std::endl;
-                if (getFitness(env) < fitness_checkpoints[checkpointIndex])
-                {
-                    finish_eval_array[currentIndIndex] = true;
-                    return true;
-                }
-            }
-        }
-        else if (subexperiment_name == "bestasref")
-        {
-            static int instance_type = settings::getParameter<settings::Integer>(parameters, "#instanceType").value;
-            static float bestasrefGrace = settings::getParameter<settings::Float>(parameters, "#bestasrefGrace").value;
-            static long unsigned bestasrefGraceTicks = lround(bestasrefGrace / time_delta);
-            
-
-            // in the first iteration
-            if (simGetSimulationTime() < time_delta * 0.5)
-            {   
-                if (instance_type == 1)
-                {
-                    loadfCheckpoints();
-                }
-            }
+    // need to return true 3 times to really stop.
+    if (ctx.stop_requested)
+    {
+        return true;
+    }
 
-            // save fitness
-            auto NIPESind = std::dynamic_pointer_cast<NIPESIndividual>(population[currentIndIndex]);
-            NIPESind->bestasref_observed_fitnesses[tick] = getFitness(env);
-            NIPESind->consumed_runtime = simGetSimulationTime() + 0.3;
+    // the stopping checks, and the ticks of the fitness curves, follow #checkPeriod
+    if (!ctx.check_due(sim_time, time_delta, time_step))
+    {
+        return false;
+    }
 
+    FitnessProbe fitness(env, population[currentIndIndex]);
+    if (early_stopping->should_stop(ctx, sim_time, fitness))
+    {
+        ctx.stop_requested = true;
+        ctx.policy_stopped = true;
+        return true;
+    }
 
-            if (tick >= bestasrefGraceTicks && getFitness(env) < bestasref_ref_fitnesses[tick - bestasrefGraceTicks])
-            {
-                std::cout << "Finish bestasref. " << std::endl;
-                // PrintArray(bestasref_ref_fitnesses, tick);
-                // PrintArray(NIPESind->bestasref_observed_fitnesses, tick);
-                finish_eval_array[currentIndIndex] = true;
-                return true;
-            }
-        }
+    if (ctx.record_curve)
+    {
+        ctx.observed_curve.record(ctx.tick, fitness());
     }
 
-    if (modifyMaxEvalTime && (double) simGetSimulationTime() + 0.3 > get_currentMaxEvalTime())
+    if (modify_max_eval_time && sim_time + STOP_LATENCY > ind.get_max_eval_time())
     {
         // checks = 0;
         // std::cout << "True returned in finish_eval()" << std::endl;
@@ -968,13 +937,6 @@ bool NIPES::finish_eval(const Environment::Ptr &env){
         return true;
     }
 
-    float tPos[3];
-    tPos[0] = settings::getParameter<settings::Double>(parameters,"#target_x").value;
-    tPos[1] = settings::getParameter<settings::Double>(parameters,"#target_y").value;
-    tPos[2] = settings::getParameter<settings::Double>(parameters,"#target_z").value;
-    double fTarget = settings::getParameter<settings::Double>(parameters,"#FTarget").value;
-    double arenaSize = settings::getParameter<settings::Double>(parameters,"#arenaSize").value;
-
     auto distance = [](float* a,float* b) -> double
     {
         return std::sqrt((a[0] - b[0])*(a[0] - b[0]) +
@@ -982,17 +944,18 @@ bool NIPES::finish_eval(const Environment::Ptr &env){
                          (a[2] - b[2])*(a[2] - b[2]));
     };
 
-    tick++;
+    ctx.tick++;
 
-    int handle = std::dynamic_pointer_cast<sim::Morphology>(population[currentIndIndex]->get_morphology())->getMainHandle();
     float pos[3];
-    simGetObjectPosition(handle,-1,pos);
-    double dist = distance(pos,tPos)/sqrt(2*arenaSize*arenaSize);
+    simGetObjectPosition(robot_handle,-1,pos);
+    double dist = distance(pos,target_position)/sqrt(2*arena_size*arena_size);
 
-    if(dist < fTarget){
+    if(dist < target_distance){
         std::cout << "STOP !" << std::endl;
+        // latched, the ticks between two checks must return true as well
+        ctx.stop_requested = true;
     }
 
-    return  dist < fTarget;
+    return  dist < target_distance;
 }
 
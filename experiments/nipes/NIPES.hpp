@@ -6,6 +6,8 @@
 #include "v_repLib.h"
 #elif defined (COPPELIASIM)
 #include "simLib.h"
+#elif defined (STANDIN_SIM)
+#include "standin_sim.h"
 #endif
 
 #include "simulatedER/mazeEnv.h"
@@ -15,8 +17,12 @@
 #include "ARE/Settings.h"
 #include "obstacleAvoidance.hpp"
 #include "../mnipes/tools.hpp"
-
-#define BESTASREF_FITNESS_ARRAY_SIZE 2000
+#include "early_stopping.hpp"
+#include "eval_context.hpp"
+#include "eval_watchdog.hpp"
+#include "novelty_index.hpp"
+#include "archive_eviction.hpp"
+#include "ARE/misc/eigen_boost_serialization.hpp"
 
 namespace are{
 
@@ -34,15 +40,42 @@ public:
         : sim::NN2Individual(morph_gen,ctrl_gen){}
     NIPESIndividual(const NIPESIndividual& ind)
         : sim::NN2Individual(ind),
+          context(ind.context),
           visited_zones(ind.visited_zones),
-          descriptor_type(ind.descriptor_type){}
+          descriptor_type(ind.descriptor_type),
+          cached_descriptor(ind.cached_descriptor),
+          generation_behaviour(ind.generation_behaviour),
+          generation_energy_cost(ind.generation_energy_cost),
+          generation_behaviour_recorded(ind.generation_behaviour_recorded),
+          max_eval_time(ind.max_eval_time),
+          generation_eval_time(ind.generation_eval_time){}
 
 
     Eigen::VectorXd descriptor() override;
-    void set_visited_zones(const Eigen::MatrixXi& vz){visited_zones = vz;}
-    void set_descriptor_type(DescriptorType dt){descriptor_type = dt;}
+    /// Compute the descriptor of the evaluation that just ended, once the final position and visited zones are set.
+    void cache_descriptor();
+    /// The cached descriptor, computed on the first call if the evaluation did not cache it.
+    const Eigen::VectorXd& get_descriptor();
+    /// The controller runs every #controlPeriod, the commands are held in between.
+    void update(double delta_time) override;
+    void set_visited_zones(const VisitedGrid& vz){visited_zones = vz; cached_descriptor.resize(0);}
+    const VisitedGrid& get_visited_zones() const {return visited_zones;}
+    void take_trajectory(std::vector<waypoint> &&traj){trajectory = std::move(traj);}
+    void set_descriptor_type(DescriptorType dt){descriptor_type = dt; cached_descriptor.resize(0);}
+    DescriptorType get_descriptor_type() const {return descriptor_type;}
     void set_max_eval_time(float in_max_eval_time){this->max_eval_time = in_max_eval_time;}
     float get_max_eval_time(){return max_eval_time;}
+    /// Runtime of the rest of the generation, the individuals sampled by the rank agreement run longer.
+    void set_generation_eval_time(float eval_time){generation_eval_time = eval_time;}
+    float get_generation_eval_time() const {return generation_eval_time;}
+    /// Fitness after runtime seconds, read from the recorded fitness curve if there is one.
+    double fitness_at_runtime(double runtime, double time_delta);
+    /// Keep the behaviour of an evaluation running longer than its generation, as it is when the others stop.
+    void set_generation_behaviour(sim::ObstacleAvoidanceState &&behaviour);
+    bool has_generation_behaviour() const {return generation_behaviour_recorded;}
+    /// Replace the final position, trajectory, visited zones and energy cost by the ones kept, if any.
+    void use_generation_behaviour();
+
     
     friend class boost::serialization::access;
     template<class archive>
@@ -50,27 +83,35 @@ public:
     {
         arch & boost::serialization::base_object<NN2Individual>(*this);
         arch & max_eval_time;
-        arch & observed_fintesses;
-        arch & fitness_checkpoints;
-        arch & bestasref_ref_fitnesses;
-        arch & bestasref_observed_fitnesses;
-        arch & consumed_runtime;
+        // the clients do not run the epochs, the generation runtime comes with the individual
+        arch & generation_eval_time;
+        arch & context;
+        // the server computes the Hamming distances of the grids sent back by the clients
+        arch & visited_zones;
+        arch & cached_descriptor;
+        arch & generation_behaviour;
+        arch & generation_energy_cost;
+        arch & generation_behaviour_recorded;
     }
 
     std::string to_string() override;
     void from_string(const std::string &str) override;
 
-    double observed_fintesses[20] = {0};
-    double fitness_checkpoints[20] = {0};
-    double bestasref_ref_fitnesses[BESTASREF_FITNESS_ARRAY_SIZE] = {0};
-    double bestasref_observed_fitnesses[BESTASREF_FITNESS_ARRAY_SIZE] = {0};
-    double consumed_runtime = 0;
+    EvalContext context;
 
 private:
 
-    Eigen::MatrixXi visited_zones;
+    VisitedGrid visited_zones;
+    PeriodicClock control_clock;
     DescriptorType descriptor_type = FINAL_POSITION;
+    // set by cache_descriptor() at the end of the evaluation, empty until then
+    Eigen::VectorXd cached_descriptor;
+    // behaviour at the runtime of the generation, for the individuals sampled by the rank agreement
+    sim::ObstacleAvoidanceState generation_behaviour;
+    double generation_energy_cost = 0;
+    bool generation_behaviour_recorded = false;
     float max_eval_time = 0;
+    float generation_eval_time = 0;
 };
 
 class NIPES : public EA
@@ -91,17 +132,20 @@ public:
 
     bool is_finish() override;
     bool finish_eval(const Environment::Ptr &env) override;
-    void write_measure_ranks_to_results();
+    void write_measure_ranks_to_results(double runtime);
+    void record_measure_ranks_curves();
     void updateNoveltyEnergybudgetArchive();
     void cma_iteration();
     void modifyMaxEvalTime_iteration();
+    void sample_rank_agreement_individuals();
+    /// Set currentMaxEvalTime to the shortest runtime ranking the sampled individuals like the full runtime.
+    void rank_agreement_iteration();
     void print_fitness_iteration();
     void write_results();
-    double getFitness(const Environment::Ptr &env);
-    void savefCheckpoints();
-    void loadfCheckpoints();
-    void bestasrefGetfCheckpointsFromIndividual(int individualIndex);
-    void getfCheckpointsFromIndividuals();
+    /// Fraction of the most consumed of the #maxNbrEval, #maxSimulatedTime and #maxWallTime budgets.
+    double budget_progress();
+    void prepare_population();
+    void record_generation_behaviour(const Environment::Ptr &env, NIPESIndividual &ind);
 
     std::string compute_population_genome_hash();
     std::string getIndividualHash(Individual::Ptr ind);
@@ -122,17 +166,28 @@ protected:
     cma::CMASolutions best_run;
     bool _is_finish = false;
     std::vector<Eigen::VectorXd> archive;
-    int n_iterations_isReevaluating = 0;
+    // visited zones of the descriptors of archive, when they are grids
+    GridBlock grid_archive;
+    // nearest neighbour index over archive, see #noveltyIndex
+    NoveltyIndex archive_index;
+    // keeps archive within #archiveMaxSize
+    ArchiveEviction archive_eviction;
+    // descriptors of the population, one column per individual, refilled every generation
+    Eigen::MatrixXd pop_descriptors;
     double og_maxEvalTime;
     stopwatch sw = stopwatch();
     stopwatch total_time_sw = stopwatch();
     double best_fitness = -__DBL_MAX__;
-    bool isReevaluating=false;
 
     std::string result_filename;
     std::string subexperiment_name;
 
     double total_time_simulating;
+    double current_max_eval_time = 0;
+    // Cost of the last generation, to stop before a generation would exceed the time budgets.
+    double last_generation_simulated_time = 0;
+    double last_generation_wall_time = 0;
+    double wall_time_at_last_epoch = 0;
 
     // Vars for init_next_pop
     int pop_size = -1;
@@ -143,15 +198,23 @@ protected:
     std::vector<double> weights;
     std::vector<double> biases;    
 
-    int n_of_halvings;
-    // In the first n_of_halvings positions, contains the runtimes in which we should check for minimum fitness.
-    bool update_fitness_checkpoints=false;
-    double time_checkpoints[20];
-    double fitness_checkpoints[20];
-    double bestasref_ref_fitnesses[BESTASREF_FITNESS_ARRAY_SIZE] = {0};
-    long unsigned int tick;
-    long bestasref_size_of_fitnesses;
-    std::vector<bool> finish_eval_array;
+    EarlyStoppingPolicy::Ptr early_stopping;
+    // simulated time between two stopping checks, and physics timestep
+    float time_delta;
+    float time_step;
+    // ends a simulator instance whose evaluation hangs, see #watchdogFactor
+    EvalWatchdog watchdog;
+    bool modify_max_eval_time;
+    // #instanceType 0, the evaluations run in this process
+    bool in_process;
+    // with a policy updated per evaluation, the individuals from this index are not sent to a simulator yet
+    size_t first_unsent = 0;
+    // #target_x/y/z, #FTarget and #arenaSize
+    float target_position[3];
+    double target_distance;
+    double arena_size;
+    // main handle of the morphology under evaluation
+    int robot_handle = -1;
 };
 
 }
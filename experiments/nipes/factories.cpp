@@ -1,4 +1,5 @@
 #include "simulatedER/mazeEnv.h"
+#include "incremental_maze_env.hpp"
 #include "NIPES.hpp"
 #include "simulatedER/nn2/NN2Individual.hpp"
 #include "NIPESLoggings.hpp"
@@ -11,7 +12,7 @@ extern "C" are::Environment::Ptr environmentFactory
     int env_type = are::settings::getParameter<are::settings::Integer>(param,"#envType").value;
     are::Environment::Ptr env;
     if(env_type == 0){
-        env.reset(new are::sim::MazeEnv);
+        env.reset(new are::sim::IncrementalMazeEnv);
         env->set_parameters(param);
     }
     else if(env_type == 1)
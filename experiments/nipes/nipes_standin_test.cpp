@@ -0,0 +1,99 @@
+#include "NIPES.hpp"
+#include "standin_sim.h"
+#include <fstream>
+#include <random>
+
+namespace are_set = are::settings;
+
+extern "C" are::Environment::Ptr environmentFactory(const are::settings::ParametersMapPtr& param);
+
+// walls of a square arena and the obstacles the collision checker looks for
+inline void write_scene(const std::string& filename, double arena_size){
+    std::ofstream ofs(filename);
+    double half = arena_size/2.;
+    ofs << "box wall_0 0 " << half << " 0.1 " << arena_size << " 0.02 0.2" << std::endl;
+    ofs << "box wall_1 0 " << -half << " 0.1 " << arena_size << " 0.02 0.2" << std::endl;
+    ofs << "box wall_2 " << half << " 0 0.1 0.02 " << arena_size << " 0.2" << std::endl;
+    ofs << "box wall_3 " << -half << " 0 0.1 0.02 " << arena_size << " 0.2" << std::endl;
+    for(int i = 0; i < 11; i++){
+        double angle = 2*M_PI*i/11.;
+        ofs << "box Obstacle_" << i << " " << 0.6*half*std::cos(angle) << " " << 0.6*half*std::sin(angle)
+            << " 0.05 0.1 0.1 0.1 " << angle << std::endl;
+    }
+}
+
+// Runs NIPES in process on the stand-in simulator, the way ER drives the evaluations in the simulator plugin.
+// usage: nipes_standin_test parameters.csv [nbr_generations] [scene]
+int main(int argc, char** argv)
+{
+    if(argc < 2){
+        std::cerr << "usage: " << argv[0] << " parameters.csv [nbr_generations] [scene]" << std::endl;
+        return 1;
+    }
+    int nbr_generations = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    are_set::ParametersMapPtr parameters = are_set::loadParameters(argv[1]);
+    delete (*parameters)["#instanceType"];
+    (*parameters)["#instanceType"] = new are_set::Integer(0);
+    std::string scene = "/tmp/nipes_standin_scene.txt";
+    if(argc > 3)
+        scene = argv[3];
+    else
+        write_scene(scene,are_set::getParameter<are_set::Double>(parameters,"#arenaSize").value);
+    delete (*parameters)["#scenePath"];
+    (*parameters)["#scenePath"] = new are_set::String(scene);
+
+    float time_step = are_set::getParameter<are_set::Float>(parameters,"#timeStep").value;
+    float max_eval_time = are_set::getParameter<are_set::Float>(parameters,"#maxEvalTime").value;
+
+    std::random_device rd;
+    int seed = rd();
+    are::misc::RandNum::Ptr rngen (new are::misc::RandNum(seed));
+
+    are::Environment::Ptr env = environmentFactory(parameters);
+    are::NIPES nipes(rngen,parameters);
+    nipes.init();
+
+    for(int gen = 0; gen < nbr_generations; gen++){
+        double best_fit = -__DBL_MAX__;
+        double avg_fitness = 0;
+        const std::vector<are::Individual::Ptr>& pop = nipes.get_population();
+        for(size_t i = 0; i < pop.size(); i++){
+            standinSimReset();
+            if(simLoadScene(scene.c_str()) < 0){
+                std::cerr << "Cannot load the scene " << scene << std::endl;
+                return 1;
+            }
+            standinSimSetTimeStep(time_step);
+            nipes.setCurrentIndIndex(i);
+            are::Individual::Ptr ind = pop[i];
+            ind->init();
+            env->init();
+            simStartSimulation();
+
+            // as the simulator, the evaluation ends a few ticks after finish_eval asks for it
+            int nbr_stops = 0;
+            while(nbr_stops < 3 && simGetSimulationTime() < max_eval_time){
+                standinSimStep();
+                ind->update(simGetSimulationTime());
+                env->updateEnv(simGetSimulationTime(),std::static_pointer_cast<are::sim::Morphology>(ind->get_morphology()));
+                if(nipes.finish_eval(env))
+                    nbr_stops++;
+            }
+            simStopSimulation();
+
+            ind->setObjectives(env->fitnessFunction(ind));
+            nipes.setObjectives(i,ind->getObjectives());
+            nipes.update(env);
+
+            double fit = ind->getObjectives()[0];
+            avg_fitness += fit;
+            if(fit > best_fit)
+                best_fit = fit;
+        }
+
+        std::cout << "generation " << gen << " best fitness : " << best_fit << " avg fitness : " << avg_fitness/pop.size() << std::endl;
+        nipes.epoch();
+        nipes.init_next_pop();
+    }
+}
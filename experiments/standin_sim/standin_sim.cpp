@@ -0,0 +1,797 @@
+#include "standin_sim.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/// Boxes whose top is below this height are floor: they neither block the robots nor are hit by the sensors.
+const float FLOOR_CLEARANCE = 0.02f;
+/// Joints closer than this to the longitudinal axis of their robot are not wheels.
+const float MIN_WHEEL_OFFSET = 1e-4f;
+
+typedef struct Object{
+    bool valid = false;
+    int type = sim_object_shape_type;
+    int parent = -1;
+    std::vector<int> children;
+    std::string name;
+    float position[3] = {0,0,0};
+    float orientation[3] = {0,0,0};
+    float half_size[3] = {0,0,0};
+    float linear_velocity[3] = {0,0,0};
+    float angular_velocity[3] = {0,0,0};
+    float joint_position = 0;
+    float joint_target_velocity = 0;
+    int special_property = 0;
+    int model_property = 0;
+    float sensor_offset = 0;
+    float sensor_range = 0;
+    int detection_state = 0;
+    float detected_point[4] = {0,0,0,0};
+    int detected_handle = -1;
+}Object;
+
+typedef struct Pose{
+    float position[3];
+    float orientation[3];
+    float joint_position;
+}Pose;
+
+typedef struct World{
+    std::vector<Object> objects;
+    std::unordered_map<std::string,int> names;
+    float time = 0;
+    float time_step = 0.05f;
+    float wheel_radius = 0.03f;
+    bool running = false;
+    // poses at simStartSimulation, put back by simStopSimulation
+    std::vector<Pose> initial_poses;
+    // scratch buffers of the step, kept to avoid allocating at every tick
+    std::vector<int> roots;
+    std::vector<int> tree;
+    std::vector<Pose> saved_poses;
+}World;
+
+World& world()
+{
+    static World w;
+    return w;
+}
+
+Object* get(int handle)
+{
+    World& w = world();
+    if(handle < 0 || handle >= static_cast<int>(w.objects.size()) || !w.objects[handle].valid)
+        return nullptr;
+    return &w.objects[handle];
+}
+
+int root_of(int handle)
+{
+    World& w = world();
+    while(w.objects[handle].parent >= 0)
+        handle = w.objects[handle].parent;
+    return handle;
+}
+
+/// Depth first, parents before their children.
+void collect_tree(int handle, int object_type, bool first_children_only, bool include_base, std::vector<int>& tree)
+{
+    const Object& obj = world().objects[handle];
+    if(include_base && (object_type == sim_handle_all || obj.type == object_type))
+        tree.push_back(handle);
+    for(int child : obj.children){
+        if(first_children_only){
+            if(object_type == sim_handle_all || world().objects[child].type == object_type)
+                tree.push_back(child);
+        }
+        else collect_tree(child,object_type,false,true,tree);
+    }
+}
+
+bool is_floor(const Object& obj)
+{
+    return obj.position[2] + obj.half_size[2] < FLOOR_CLEARANCE;
+}
+
+/// Half extents of the axis aligned bounding box of a box turned by its yaw.
+void aabb_half_size(const Object& obj, float* half)
+{
+    float c = std::fabs(std::cos(obj.orientation[2])), s = std::fabs(std::sin(obj.orientation[2]));
+    half[0] = c*obj.half_size[0] + s*obj.half_size[1];
+    half[1] = s*obj.half_size[0] + c*obj.half_size[1];
+    half[2] = obj.half_size[2];
+}
+
+bool overlap(const Object& a, const Object& b)
+{
+    float ha[3], hb[3];
+    aabb_half_size(a,ha);
+    aabb_half_size(b,hb);
+    for(int i = 0; i < 3; i++)
+        if(std::fabs(a.position[i] - b.position[i]) > ha[i] + hb[i])
+            return false;
+    return true;
+}
+
+/// Distance along the ray to the box, or -1 if it is not hit within range.
+float ray_box(const float* origin, const float* dir, float range, const Object& box)
+{
+    // in the frame of the box
+    float c = std::cos(box.orientation[2]), s = std::sin(box.orientation[2]);
+    float dx = origin[0] - box.position[0], dy = origin[1] - box.position[1];
+    float o[3] = {c*dx + s*dy, -s*dx + c*dy, origin[2] - box.position[2]};
+    float d[3] = {c*dir[0] + s*dir[1], -s*dir[0] + c*dir[1], dir[2]};
+    float t_min = 0, t_max = range;
+    for(int i = 0; i < 3; i++){
+        if(std::fabs(d[i]) < 1e-9f){
+            if(std::fabs(o[i]) > box.half_size[i])
+                return -1;
+            continue;
+        }
+        float t1 = (-box.half_size[i] - o[i])/d[i];
+        float t2 = (box.half_size[i] - o[i])/d[i];
+        if(t1 > t2)
+            std::swap(t1,t2);
+        t_min = std::max(t_min,t1);
+        t_max = std::min(t_max,t2);
+        if(t_min > t_max)
+            return -1;
+    }
+    return t_min;
+}
+
+int create_object(int type, const char* base_name)
+{
+    World& w = world();
+    int handle = static_cast<int>(w.objects.size());
+    w.objects.emplace_back();
+    Object& obj = w.objects.back();
+    obj.valid = true;
+    obj.type = type;
+    std::stringstream sstr;
+    sstr << base_name << handle;
+    obj.name = sstr.str();
+    w.names[obj.name] = handle;
+    return handle;
+}
+
+void save_pose(const Object& obj, Pose& pose)
+{
+    std::copy_n(obj.position,3,pose.position);
+    std::copy_n(obj.orientation,3,pose.orientation);
+    pose.joint_position = obj.joint_position;
+}
+
+void load_pose(const Pose& pose, Object& obj)
+{
+    std::copy_n(pose.position,3,obj.position);
+    std::copy_n(pose.orientation,3,obj.orientation);
+    obj.joint_position = pose.joint_position;
+}
+
+/// Differential drive of the tree of root from the target velocities of its wheels.
+void drive(int root)
+{
+    World& w = world();
+    Object& base = w.objects[root];
+    float dt = w.time_step;
+
+    w.tree.clear();
+    collect_tree(root,sim_handle_all,false,true,w.tree);
+
+    float c = std::cos(base.orientation[2]), s = std::sin(base.orientation[2]);
+    float left_velocity = 0, right_velocity = 0, left_offset = 0, right_offset = 0;
+    int nbr_left = 0, nbr_right = 0;
+    for(int handle : w.tree){
+        Object& obj = w.objects[handle];
+        if(obj.type != sim_object_joint_type)
+            continue;
+        obj.joint_position += obj.joint_target_velocity*dt;
+        float lateral = -s*(obj.position[0] - base.position[0]) + c*(obj.position[1] - base.position[1]);
+        if(lateral > MIN_WHEEL_OFFSET){
+            left_velocity += obj.joint_target_velocity;
+            left_offset += lateral;
+            nbr_left++;
+        }else if(lateral < -MIN_WHEEL_OFFSET){
+            right_velocity += obj.joint_target_velocity;
+            right_offset += lateral;
+            nbr_right++;
+        }
+    }
+
+    for(int handle : w.tree){
+        std::fill_n(w.objects[handle].linear_velocity,3,0.f);
+        std::fill_n(w.objects[handle].angular_velocity,3,0.f);
+    }
+    if(nbr_left == 0 || nbr_right == 0)
+        return;
+
+    left_velocity *= w.wheel_radius/nbr_left;
+    right_velocity *= w.wheel_radius/nbr_right;
+    float axle = left_offset/nbr_left - right_offset/nbr_right;
+    float speed = (left_velocity + right_velocity)/2;
+    float turn_rate = (right_velocity - left_velocity)/axle;
+
+    float dyaw = turn_rate*dt;
+    float heading = base.orientation[2] + dyaw/2;
+    float dx = speed*dt*std::cos(heading), dy = speed*dt*std::sin(heading);
+    float cr = std::cos(dyaw), sr = std::sin(dyaw);
+    float pivot[2] = {base.position[0], base.position[1]};
+
+    w.saved_poses.resize(w.tree.size());
+    for(size_t i = 0; i < w.tree.size(); i++){
+        Object& obj = w.objects[w.tree[i]];
+        save_pose(obj,w.saved_poses[i]);
+        float rx = obj.position[0] - pivot[0], ry = obj.position[1] - pivot[1];
+        obj.position[0] = pivot[0] + dx + cr*rx - sr*ry;
+        obj.position[1] = pivot[1] + dy + sr*rx + cr*ry;
+        obj.orientation[2] += dyaw;
+    }
+
+    // blocked by the boxes of the other trees
+    bool blocked = false;
+    for(size_t i = 0; i < w.tree.size() && !blocked; i++){
+        const Object& obj = w.objects[w.tree[i]];
+        if(obj.type != sim_object_shape_type)
+            continue;
+        for(size_t h = 0; h < w.objects.size() && !blocked; h++){
+            const Object& other = w.objects[h];
+            if(!other.valid || other.type != sim_object_shape_type || is_floor(other) || root_of(h) == root)
+                continue;
+            blocked = overlap(obj,other);
+        }
+    }
+    if(blocked){
+        for(size_t i = 0; i < w.tree.size(); i++){
+            Object& obj = w.objects[w.tree[i]];
+            float joint_position = obj.joint_position;
+            load_pose(w.saved_poses[i],obj);
+            obj.joint_position = joint_position;
+        }
+        return;
+    }
+
+    for(int handle : w.tree){
+        Object& obj = w.objects[handle];
+        obj.linear_velocity[0] = dx/dt;
+        obj.linear_velocity[1] = dy/dt;
+        obj.angular_velocity[2] = turn_rate;
+    }
+}
+
+void sense(int sensor_handle)
+{
+    World& w = world();
+    Object& sensor = w.objects[sensor_handle];
+    float dir[3] = {std::cos(sensor.orientation[2]), std::sin(sensor.orientation[2]), 0};
+    float origin[3] = {sensor.position[0] + sensor.sensor_offset*dir[0],
+                       sensor.position[1] + sensor.sensor_offset*dir[1],
+                       sensor.position[2]};
+    int root = root_of(sensor_handle);
+
+    sensor.detection_state = 0;
+    sensor.detected_handle = -1;
+    float closest = sensor.sensor_range;
+    for(size_t h = 0; h < w.objects.size(); h++){
+        const Object& obj = w.objects[h];
+        if(!obj.valid || obj.type != sim_object_shape_type || is_floor(obj) || root_of(h) == root)
+            continue;
+        float t = ray_box(origin,dir,closest,obj);
+        if(t >= 0 && t <= closest){
+            closest = t;
+            sensor.detection_state = 1;
+            sensor.detected_handle = static_cast<int>(h);
+        }
+    }
+    // as for a CoppeliaSim ray sensor, the ray is the z axis of the sensor frame
+    float distance = sensor.detection_state ? closest + sensor.sensor_offset : 0;
+    sensor.detected_point[0] = 0;
+    sensor.detected_point[1] = 0;
+    sensor.detected_point[2] = distance;
+    sensor.detected_point[3] = distance;
+}
+
+int read_sensor(int sensor_handle, simFloat* detected_point, simInt* detected_object, simFloat* normal)
+{
+    Object* sensor = get(sensor_handle);
+    if(!sensor || sensor->type != sim_object_proximitysensor_type)
+        return -1;
+    if(detected_point)
+        std::copy_n(sensor->detected_point,4,detected_point);
+    if(detected_object)
+        *detected_object = sensor->detected_handle;
+    if(normal){
+        normal[0] = normal[1] = 0;
+        normal[2] = -1;
+    }
+    return sensor->detection_state;
+}
+
+/// Frame used for relative poses: -1 for absolute, the parent for sim_handle_parent.
+bool reference_frame(int handle, int relative_to, const Object*& frame)
+{
+    frame = nullptr;
+    if(relative_to == -1)
+        return true;
+    if(relative_to == sim_handle_parent){
+        frame = get(get(handle)->parent);
+        return true;
+    }
+    frame = get(relative_to);
+    return frame != nullptr;
+}
+
+}
+
+simInt simStartSimulation()
+{
+    World& w = world();
+    w.initial_poses.resize(w.objects.size());
+    for(size_t i = 0; i < w.objects.size(); i++)
+        save_pose(w.objects[i],w.initial_poses[i]);
+    w.time = 0;
+    w.running = true;
+    return 1;
+}
+
+simInt simStopSimulation()
+{
+    World& w = world();
+    for(size_t i = 0; i < w.initial_poses.size() && i < w.objects.size(); i++){
+        Object& obj = w.objects[i];
+        load_pose(w.initial_poses[i],obj);
+        obj.joint_target_velocity = 0;
+        std::fill_n(obj.linear_velocity,3,0.f);
+        std::fill_n(obj.angular_velocity,3,0.f);
+        obj.detection_state = 0;
+    }
+    w.time = 0;
+    w.running = false;
+    return 1;
+}
+
+simFloat simGetSimulationTime()
+{
+    return world().time;
+}
+
+simFloat simGetSimulationTimeStep()
+{
+    return world().time_step;
+}
+
+simInt simLoadScene(const simChar* filename)
+{
+    std::ifstream ifs(filename);
+    if(!ifs)
+        return -1;
+    std::string line;
+    while(std::getline(ifs,line)){
+        line = line.substr(0,line.find('#'));
+        std::stringstream sstr(line);
+        std::string kind, name;
+        if(!(sstr >> kind))
+            continue;
+        float pos[3], size[3], yaw = 0;
+        if(kind != "box" || !(sstr >> name >> pos[0] >> pos[1] >> pos[2] >> size[0] >> size[1] >> size[2]))
+            return -1;
+        sstr >> yaw;
+        int handle = simCreatePureShape(0,8,size,0,nullptr);
+        simSetObjectName(handle,name.c_str());
+        simSetObjectPosition(handle,-1,pos);
+        float orientation[3] = {0,0,yaw};
+        simSetObjectOrientation(handle,-1,orientation);
+        simSetModelProperty(handle,sim_modelproperty_not_dynamic);
+    }
+    return 1;
+}
+
+simInt simGetObjectHandle(const simChar* objectName)
+{
+    auto it = world().names.find(objectName);
+    if(it == world().names.end())
+        return -1;
+    return it->second;
+}
+
+simChar* simGetObjectName(simInt objectHandle)
+{
+    Object* obj = get(objectHandle);
+    if(!obj)
+        return nullptr;
+    simChar* name = static_cast<simChar*>(std::malloc(obj->name.size() + 1));
+    std::strcpy(name,obj->name.c_str());
+    return name;
+}
+
+simInt simSetObjectName(simInt objectHandle,const simChar* objectName)
+{
+    World& w = world();
+    Object* obj = get(objectHandle);
+    if(!obj)
+        return -1;
+    auto it = w.names.find(objectName);
+    if(it != w.names.end())
+        return it->second == objectHandle ? 1 : -1;
+    w.names.erase(obj->name);
+    obj->name = objectName;
+    w.names[obj->name] = objectHandle;
+    return 1;
+}
+
+simInt simGetObjects(simInt index,simInt objectType)
+{
+    World& w = world();
+    for(size_t h = 0; h < w.objects.size(); h++){
+        if(!w.objects[h].valid || (objectType != sim_handle_all && w.objects[h].type != objectType))
+            continue;
+        if(index-- == 0)
+            return static_cast<simInt>(h);
+    }
+    return -1;
+}
+
+simInt* simGetObjectsInTree(simInt treeBaseHandle,simInt objectType,simInt options,simInt* objectCount)
+{
+    if(!get(treeBaseHandle))
+        return nullptr;
+    // bit 0: exclude the tree base, bit 1: first children only
+    std::vector<int> tree;
+    collect_tree(treeBaseHandle,objectType,(options & 2) != 0,(options & 1) == 0,tree);
+    simInt* handles = static_cast<simInt*>(std::malloc(std::max<size_t>(1,tree.size())*sizeof(simInt)));
+    std::copy(tree.begin(),tree.end(),handles);
+    *objectCount = static_cast<simInt>(tree.size());
+    return handles;
+}
+
+simInt simGetObjectType(simInt objectHandle)
+{
+    Object* obj = get(objectHandle);
+    return obj ? obj->type : -1;
+}
+
+simInt simIsHandleValid(simInt generalObjectHandle,simInt generalObjectType)
+{
+    if(generalObjectType != -1 && generalObjectType != sim_appobj_object_type)
+        return -1;
+    return get(generalObjectHandle) ? 1 : 0;
+}
+
+simInt simGetObjectParent(simInt objectHandle)
+{
+    Object* obj = get(objectHandle);
+    return obj ? obj->parent : -1;
+}
+
+simInt simSetObjectParent(simInt objectHandle,simInt parentObjectHandle,simBool /*keepInPlace*/)
+{
+    // poses are absolute, keepInPlace is always true
+    World& w = world();
+    Object* obj = get(objectHandle);
+    if(!obj || (parentObjectHandle != -1 && !get(parentObjectHandle)))
+        return -1;
+    for(int p = parentObjectHandle; p >= 0; p = w.objects[p].parent)
+        if(p == objectHandle)
+            return -1;
+    if(obj->parent >= 0){
+        std::vector<int>& siblings = w.objects[obj->parent].children;
+        siblings.erase(std::find(siblings.begin(),siblings.end(),objectHandle));
+    }
+    obj->parent = parentObjectHandle;
+    if(parentObjectHandle >= 0)
+        w.objects[parentObjectHandle].children.push_back(objectHandle);
+    return 1;
+}
+
+simInt simRemoveObject(simInt objectHandle)
+{
+    World& w = world();
+    Object* obj = get(objectHandle);
+    if(!obj)
+        return -1;
+    for(int child : std::vector<int>(obj->children))
+        simSetObjectParent(child,-1,1);
+    simSetObjectParent(objectHandle,-1,1);
+    w.names.erase(obj->name);
+    *obj = Object();
+    return 1;
+}
+
+simInt simReleaseBuffer(const simChar* buffer)
+{
+    std::free(const_cast<simChar*>(buffer));
+    return 1;
+}
+
+simInt simGetObjectPosition(simInt objectHandle,simInt relativeToObjectHandle,simFloat* position)
+{
+    Object* obj = get(objectHandle);
+    const Object* frame;
+    if(!obj || !reference_frame(objectHandle,relativeToObjectHandle,frame))
+        return -1;
+    if(!frame){
+        std::copy_n(obj->position,3,position);
+        return 1;
+    }
+    float c = std::cos(frame->orientation[2]), s = std::sin(frame->orientation[2]);
+    float dx = obj->position[0] - frame->position[0], dy = obj->position[1] - frame->position[1];
+    position[0] = c*dx + s*dy;
+    position[1] = -s*dx + c*dy;
+    position[2] = obj->position[2] - frame->position[2];
+    return 1;
+}
+
+simInt simSetObjectPosition(simInt objectHandle,simInt relativeToObjectHandle,const simFloat* position)
+{
+    Object* obj = get(objectHandle);
+    const Object* frame;
+    if(!obj || !reference_frame(objectHandle,relativeToObjectHandle,frame))
+        return -1;
+    float absolute[3] = {position[0], position[1], position[2]};
+    if(frame){
+        float c = std::cos(frame->orientation[2]), s = std::sin(frame->orientation[2]);
+        absolute[0] = frame->position[0] + c*position[0] - s*position[1];
+        absolute[1] = frame->position[1] + s*position[0] + c*position[1];
+        absolute[2] = frame->position[2] + position[2];
+    }
+    // the children follow, as in CoppeliaSim
+    World& w = world();
+    w.tree.clear();
+    collect_tree(objectHandle,sim_handle_all,false,true,w.tree);
+    float delta[3] = {absolute[0] - obj->position[0], absolute[1] - obj->position[1], absolute[2] - obj->position[2]};
+    for(int handle : w.tree)
+        for(int i = 0; i < 3; i++)
+            w.objects[handle].position[i] += delta[i];
+    return 1;
+}
+
+simInt simGetObjectOrientation(simInt objectHandle,simInt relativeToObjectHandle,simFloat* eulerAngles)
+{
+    Object* obj = get(objectHandle);
+    const Object* frame;
+    if(!obj || !reference_frame(objectHandle,relativeToObjectHandle,frame))
+        return -1;
+    for(int i = 0; i < 3; i++)
+        eulerAngles[i] = obj->orientation[i] - (frame ? frame->orientation[i] : 0);
+    return 1;
+}
+
+simInt simSetObjectOrientation(simInt objectHandle,simInt relativeToObjectHandle,const simFloat* eulerAngles)
+{
+    Object* obj = get(objectHandle);
+    const Object* frame;
+    if(!obj || !reference_frame(objectHandle,relativeToObjectHandle,frame))
+        return -1;
+    float absolute[3];
+    for(int i = 0; i < 3; i++)
+        absolute[i] = eulerAngles[i] + (frame ? frame->orientation[i] : 0);
+
+    // the children turn around the object
+    World& w = world();
+    float dyaw = absolute[2] - obj->orientation[2];
+    float c = std::cos(dyaw), s = std::sin(dyaw);
+    w.tree.clear();
+    collect_tree(objectHandle,sim_handle_all,false,false,w.tree);
+    for(int handle : w.tree){
+        Object& child = w.objects[handle];
+        float rx = child.position[0] - obj->position[0], ry = child.position[1] - obj->position[1];
+        child.position[0] = obj->position[0] + c*rx - s*ry;
+        child.position[1] = obj->position[1] + s*rx + c*ry;
+        child.orientation[2] += dyaw;
+    }
+    std::copy_n(absolute,3,obj->orientation);
+    return 1;
+}
+
+simInt simGetObjectVelocity(simInt objectHandle,simFloat* linearVelocity,simFloat* angularVelocity)
+{
+    Object* obj = get(objectHandle);
+    if(!obj)
+        return -1;
+    if(linearVelocity)
+        std::copy_n(obj->linear_velocity,3,linearVelocity);
+    if(angularVelocity)
+        std::copy_n(obj->angular_velocity,3,angularVelocity);
+    return 1;
+}
+
+simInt simResetDynamicObject(simInt objectHandle)
+{
+    return get(objectHandle) ? 1 : -1;
+}
+
+simInt simGetObjectFloatParameter(simInt objectHandle,simInt parameterID,simFloat* parameter)
+{
+    Object* obj = get(objectHandle);
+    if(!obj)
+        return -1;
+    if(parameterID >= sim_objfloatparam_objbbox_min_x && parameterID <= sim_objfloatparam_objbbox_min_z)
+        *parameter = -obj->half_size[parameterID - sim_objfloatparam_objbbox_min_x];
+    else if(parameterID >= sim_objfloatparam_objbbox_max_x && parameterID <= sim_objfloatparam_objbbox_max_z)
+        *parameter = obj->half_size[parameterID - sim_objfloatparam_objbbox_max_x];
+    else return 0;
+    return 1;
+}
+
+simInt simSetObjectFloatParameter(simInt objectHandle,simInt parameterID,simFloat parameter)
+{
+    Object* obj = get(objectHandle);
+    if(!obj)
+        return -1;
+    if(parameterID >= sim_shapefloatparam_init_velocity_x && parameterID <= sim_shapefloatparam_init_velocity_z)
+        obj->linear_velocity[parameterID - sim_shapefloatparam_init_velocity_x] = parameter;
+    else if(parameterID >= sim_shapefloatparam_init_ang_velocity_x && parameterID <= sim_shapefloatparam_init_ang_velocity_z)
+        obj->angular_velocity[parameterID - sim_shapefloatparam_init_ang_velocity_x] = parameter;
+    else return 0;
+    return 1;
+}
+
+simInt simSetObjectSpecialProperty(simInt objectHandle,simInt prop)
+{
+    Object* obj = get(objectHandle);
+    if(!obj)
+        return -1;
+    obj->special_property = prop;
+    return 1;
+}
+
+simInt simSetModelProperty(simInt objectHandle,simInt prop)
+{
+    Object* obj = get(objectHandle);
+    if(!obj)
+        return -1;
+    obj->model_property = prop;
+    return 1;
+}
+
+simInt simSetEngineFloatParameter(simInt /*paramId*/,simInt objectHandle,const simVoid* /*object*/,simFloat /*val*/)
+{
+    // no dynamics engine
+    return get(objectHandle) ? 1 : -1;
+}
+
+simInt simCreatePureShape(simInt /*primitiveType*/,simInt /*options*/,const simFloat* sizes,simFloat /*mass*/,const simInt* /*precision*/)
+{
+    // every primitive is approximated by its bounding box
+    int handle = create_object(sim_object_shape_type,"Shape");
+    for(int i = 0; i < 3; i++)
+        world().objects[handle].half_size[i] = sizes[i]/2;
+    return handle;
+}
+
+simInt simCreateDummy(simFloat /*size*/,const simFloat* /*color*/)
+{
+    return create_object(sim_object_dummy_type,"Dummy");
+}
+
+simInt simCreateJoint(simInt /*jointType*/,simInt /*jointMode*/,simInt /*options*/,const simFloat* /*sizes*/,const simFloat* /*colorA*/,const simFloat* /*colorB*/)
+{
+    return create_object(sim_object_joint_type,"Joint");
+}
+
+simInt simCreateProximitySensor(simInt /*sensorType*/,simInt /*subType*/,simInt /*options*/,const simInt* /*intParams*/,const simFloat* floatParams,const simFloat* /*color*/)
+{
+    int handle = create_object(sim_object_proximitysensor_type,"Proximity_sensor");
+    Object& sensor = world().objects[handle];
+    sensor.sensor_offset = floatParams[0];
+    sensor.sensor_range = floatParams[1];
+    return handle;
+}
+
+simInt simGetJointPosition(simInt objectHandle,simFloat* position)
+{
+    Object* obj = get(objectHandle);
+    if(!obj || obj->type != sim_object_joint_type)
+        return -1;
+    *position = obj->joint_position;
+    return 1;
+}
+
+simInt simSetJointPosition(simInt objectHandle,simFloat position)
+{
+    Object* obj = get(objectHandle);
+    if(!obj || obj->type != sim_object_joint_type)
+        return -1;
+    obj->joint_position = position;
+    return 1;
+}
+
+simInt simGetJointTargetVelocity(simInt objectHandle,simFloat* targetVelocity)
+{
+    Object* obj = get(objectHandle);
+    if(!obj || obj->type != sim_object_joint_type)
+        return -1;
+    *targetVelocity = obj->joint_target_velocity;
+    return 1;
+}
+
+simInt simSetJointTargetVelocity(simInt objectHandle,simFloat targetVelocity)
+{
+    Object* obj = get(objectHandle);
+    if(!obj || obj->type != sim_object_joint_type)
+        return -1;
+    obj->joint_target_velocity = targetVelocity;
+    return 1;
+}
+
+simInt simCheckCollision(simInt entity1Handle,simInt entity2Handle)
+{
+    Object* a = get(entity1Handle);
+    Object* b = get(entity2Handle);
+    if(!a || !b)
+        return -1;
+    if(a->type != sim_object_shape_type || b->type != sim_object_shape_type)
+        return 0;
+    return overlap(*a,*b) ? 1 : 0;
+}
+
+simInt simHandleProximitySensor(simInt sensorHandle,simFloat* detectedPoint,simInt* detectedObjectHandle,simFloat* normalVector)
+{
+    Object* sensor = get(sensorHandle);
+    if(!sensor || sensor->type != sim_object_proximitysensor_type)
+        return -1;
+    sense(sensorHandle);
+    return read_sensor(sensorHandle,detectedPoint,detectedObjectHandle,normalVector);
+}
+
+simInt simReadProximitySensor(simInt sensorHandle,simFloat* detectedPoint,simInt* detectedObjectHandle,simFloat* normalVector)
+{
+    return read_sensor(sensorHandle,detectedPoint,detectedObjectHandle,normalVector);
+}
+
+simInt standinSimStep()
+{
+    World& w = world();
+    if(!w.running)
+        return -1;
+
+    w.roots.clear();
+    for(size_t h = 0; h < w.objects.size(); h++)
+        if(w.objects[h].valid && w.objects[h].parent < 0)
+            w.roots.push_back(static_cast<int>(h));
+    for(int root : w.roots)
+        drive(root);
+
+    for(size_t h = 0; h < w.objects.size(); h++)
+        if(w.objects[h].valid && w.objects[h].type == sim_object_proximitysensor_type)
+            sense(static_cast<int>(h));
+
+    w.time += w.time_step;
+    return 1;
+}
+
+simInt standinSimSetTimeStep(simFloat dt)
+{
+    if(dt <= 0)
+        return -1;
+    world().time_step = dt;
+    return 1;
+}
+
+simInt standinSimSetWheelRadius(simFloat radius)
+{
+    if(radius <= 0)
+        return -1;
+    world().wheel_radius = radius;
+    return 1;
+}
+
+simInt standinSimReset()
+{
+    World& w = world();
+    w.objects.clear();
+    w.names.clear();
+    w.initial_poses.clear();
+    w.time = 0;
+    w.running = false;
+    return 1;
+}
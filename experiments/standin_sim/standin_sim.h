@@ -0,0 +1,111 @@
+#ifndef STANDIN_SIM_H
+#define STANDIN_SIM_H
+
+/**
+ * Headless kinematic stand-in for the subset of the CoppeliaSim C API used by the experiments.
+ * Selected at build time with -DSTANDIN_SIM, in place of v_repLib.h (VREP) or simLib.h (COPPELIASIM).
+ *
+ * The world is a set of objects with absolute poses: box shapes, joints, dummies and ray proximity sensors.
+ * Only planar motion is simulated. A tree whose joints are on both sides of its root is driven as a
+ * differential-drive robot from the target velocities of these joints, with a fixed timestep, and it is
+ * blocked by the boxes standing above the floor. There are no dynamics, no meshes and no scripts.
+ */
+
+typedef int simInt;
+typedef float simFloat;
+typedef double simDouble;
+typedef char simChar;
+typedef unsigned char simBool;
+typedef void simVoid;
+
+#define sim_handle_all -2
+#define sim_handle_parent -11
+#define sim_appobj_object_type 109
+
+#define sim_object_shape_type 0
+#define sim_object_joint_type 1
+#define sim_object_dummy_type 4
+#define sim_object_proximitysensor_type 5
+
+#define sim_joint_revolute_subtype 10
+#define sim_joint_prismatic_subtype 11
+
+#define sim_modelproperty_not_dynamic 0x0020
+#define sim_objectspecialproperty_detectable_ultrasonic 0x0010
+
+#define sim_bullet_body_friction 6002
+
+#define sim_objfloatparam_objbbox_min_x 15
+#define sim_objfloatparam_objbbox_min_y 16
+#define sim_objfloatparam_objbbox_min_z 17
+#define sim_objfloatparam_objbbox_max_x 18
+#define sim_objfloatparam_objbbox_max_y 19
+#define sim_objfloatparam_objbbox_max_z 20
+#define sim_shapefloatparam_init_velocity_x 3000
+#define sim_shapefloatparam_init_velocity_y 3001
+#define sim_shapefloatparam_init_velocity_z 3002
+#define sim_shapefloatparam_init_ang_velocity_x 3020
+#define sim_shapefloatparam_init_ang_velocity_y 3021
+#define sim_shapefloatparam_init_ang_velocity_z 3022
+
+// Simulation
+simInt simStartSimulation();
+simInt simStopSimulation();
+simFloat simGetSimulationTime();
+simFloat simGetSimulationTimeStep();
+/// Text scene, one object per line: "box <name> <x> <y> <z> <size x> <size y> <size z> [<yaw>]", '#' starts a comment.
+simInt simLoadScene(const simChar* filename);
+
+// Objects
+simInt simGetObjectHandle(const simChar* objectName);
+simChar* simGetObjectName(simInt objectHandle);
+simInt simSetObjectName(simInt objectHandle,const simChar* objectName);
+simInt simGetObjects(simInt index,simInt objectType);
+simInt* simGetObjectsInTree(simInt treeBaseHandle,simInt objectType,simInt options,simInt* objectCount);
+simInt simGetObjectType(simInt objectHandle);
+simInt simIsHandleValid(simInt generalObjectHandle,simInt generalObjectType);
+simInt simGetObjectParent(simInt objectHandle);
+simInt simSetObjectParent(simInt objectHandle,simInt parentObjectHandle,simBool keepInPlace);
+simInt simRemoveObject(simInt objectHandle);
+simInt simReleaseBuffer(const simChar* buffer);
+
+simInt simGetObjectPosition(simInt objectHandle,simInt relativeToObjectHandle,simFloat* position);
+simInt simSetObjectPosition(simInt objectHandle,simInt relativeToObjectHandle,const simFloat* position);
+simInt simGetObjectOrientation(simInt objectHandle,simInt relativeToObjectHandle,simFloat* eulerAngles);
+simInt simSetObjectOrientation(simInt objectHandle,simInt relativeToObjectHandle,const simFloat* eulerAngles);
+simInt simGetObjectVelocity(simInt objectHandle,simFloat* linearVelocity,simFloat* angularVelocity);
+simInt simResetDynamicObject(simInt objectHandle);
+simInt simGetObjectFloatParameter(simInt objectHandle,simInt parameterID,simFloat* parameter);
+simInt simSetObjectFloatParameter(simInt objectHandle,simInt parameterID,simFloat parameter);
+simInt simSetObjectSpecialProperty(simInt objectHandle,simInt prop);
+simInt simSetModelProperty(simInt objectHandle,simInt prop);
+simInt simSetEngineFloatParameter(simInt paramId,simInt objectHandle,const simVoid* object,simFloat val);
+
+simInt simCreatePureShape(simInt primitiveType,simInt options,const simFloat* sizes,simFloat mass,const simInt* precision);
+simInt simCreateDummy(simFloat size,const simFloat* color);
+simInt simCreateJoint(simInt jointType,simInt jointMode,simInt options,const simFloat* sizes,const simFloat* colorA,const simFloat* colorB);
+/// floatParams[0] is the offset and floatParams[1] the range. The ray is cast along the heading of the sensor.
+simInt simCreateProximitySensor(simInt sensorType,simInt subType,simInt options,const simInt* intParams,const simFloat* floatParams,const simFloat* color);
+
+// Joints
+simInt simGetJointPosition(simInt objectHandle,simFloat* position);
+simInt simSetJointPosition(simInt objectHandle,simFloat position);
+simInt simGetJointTargetVelocity(simInt objectHandle,simFloat* targetVelocity);
+simInt simSetJointTargetVelocity(simInt objectHandle,simFloat targetVelocity);
+
+// Collisions and sensors
+/// Overlap of the bounding boxes of two shapes, 1 if they collide, 0 if not, -1 on an invalid handle.
+simInt simCheckCollision(simInt entity1Handle,simInt entity2Handle);
+simInt simHandleProximitySensor(simInt sensorHandle,simFloat* detectedPoint,simInt* detectedObjectHandle,simFloat* normalVector);
+simInt simReadProximitySensor(simInt sensorHandle,simFloat* detectedPoint,simInt* detectedObjectHandle,simFloat* normalVector);
+
+// Stand-in only: what the simulator main loop does around the plugins.
+/// Advance the simulation by one timestep: move the robots, then update the proximity sensors.
+simInt standinSimStep();
+simInt standinSimSetTimeStep(simFloat dt);
+/// Radius of the wheels, used to turn joint velocities into robot velocities. 0.03 by default.
+simInt standinSimSetWheelRadius(simFloat radius);
+/// Remove every object and set the simulation time back to 0.
+simInt standinSimReset();
+
+#endif //STANDIN_SIM_H